@@ -1,11 +1,22 @@
 #include "Chopper.h"
 #include <iostream>
+#include "Shard_Channel.h"
 #include "SimulationException.h"
 
-Chopper::Chopper(const std::string &name, const Point& pos) : Vehicle(name, 0, 0, pos){}
+Chopper::Chopper(Model& model, const std::string &name, const Point& pos) : Vehicle(model, name, KIND, 0, 0, pos){}
 
-Chopper::Chopper(const std::string& name, const double speed, const int course, const Point& pos)
-    : Vehicle(name, speed, course, pos) {}
+Chopper::Chopper(Model& model, const std::string& name, const double speed, const int course, const Point& pos)
+    : Vehicle(model, name, KIND, speed, course, pos) {}
+
+// Queued attacks come without handles, end_step finds their trucks by order.
+Chopper::Chopper(Model& model, Shard_Message& message)
+    : Vehicle(model, KIND, message), range(message.get<double>()), stolen(message.get<int>()) {
+    attack_queue.resize(message.get<std::uint32_t>());
+    for (auto& attack_obj : attack_queue) {
+        attack_obj.order = message.get<std::size_t>();
+        attack_obj.tick = message.get<int>();
+    }
+}
 
 void Chopper::set_parameters(const double speed, const double course) {
     if (speed > 0 && speed <= 170 && course >= 0 && course <= 360)
@@ -26,16 +37,15 @@ int Chopper::get_stolen_crates() const {
     return stolen;
 }
 
-void Chopper::broadcast_current_state() const {
-    std::cout << "Chopper " << get_name() << " at ";
-    get_location().print();
+void Chopper::broadcast_current_state(Status_Text& out) const {
+    out << "Chopper " << get_name() << " at " << get_location();
     switch (get_status()) {
         case Stopped:
-            std::cout<< ", Stopped"<<std::endl;
+            out<< ", Stopped"<<'\n';
             break;
         case MovingOnCourse:
-            std::cout << ", Heading on course " << get_course() <<
-        " deg, speed " << get_speed() << " km/h" << std::endl;
+            out << ", Heading on course " << get_course() <<
+        " deg, speed " << get_speed() << " km/h" << '\n';
         default:
             break;
     }
@@ -57,7 +67,7 @@ void Chopper::attack(Truck& target) {
     }
 
     // Check if cops are nearby (10KM)
-    const bool cops_nearby = Model::get_instance().is_police_within_range(target.get_location());
+    const bool cops_nearby = get_model().is_police_within_range(target.get_location());
     set_status(Stopped);
     if (cops_nearby) {
         decrease_range();
@@ -76,37 +86,80 @@ bool Chopper::is_in_range(const Truck& target) const {
     return calculate_distance(Vehicle::get_location(), target.get_location()) <= this->range;
 }
 
-void Chopper::queue_attack(const std::string& target, const int time) {
-    Truck* aah = Model::get_instance().find_truck_by_name(target);
-    if (is_in_range(*aah)) {
-        attack(*aah);
+void Chopper::queue_attack(Truck& target, const int time) {
+    if (is_in_range(target)) {
+        attack(target);
         return;
     }
     for (const auto& attack_obj : attack_queue) {
-        if (attack_obj.target == target) {
+        if (attack_obj.order == target.get_order()) {
             return;
         }
     }
-    attack_queue.push_back({aah->get_name(), time + 1});
-}
-
-void Chopper::update() {
-    if (get_status() != Stopped)
-        Vehicle::update();
-    else {
-        // If there are queued attacks, try to preform them.
-        for (const auto& attack_obj : attack_queue) {
-            Truck* target = Model::get_instance().find_truck_by_name(attack_obj.target);
-            try {
-                if (attack_obj.tick == Model::get_instance().get_time()) {
-                    attack(*target);
-                }
-            }
-            catch (const SimulationException& e) {
-                std::cout << e.what() << std::endl;
+    attack_queue.push_back({target.get_handle(), target.get_order(), time + 1});
+    wake();
+}
+
+bool Chopper::is_dormant() const {
+    return get_status() == Stopped && attack_queue.empty();
+}
+
+bool Chopper::has_due_attack(const int time) const {
+    if (is_moving())
+        return false;
+    for (const auto& attack_obj : attack_queue)
+        if (attack_obj.tick == time)
+            return true;
+    return false;
+}
+
+const std::vector<AttackCommand>& Chopper::get_attack_queue() const {
+    return attack_queue;
+}
+
+void Chopper::end_step() {
+    if (is_moving())
+        return;
+
+    // If there are queued attacks, try to preform them, a target that is gone is dropped.
+    // A target without a live handle was moved in from another world, it is found by its order.
+    for (const auto& attack_obj : attack_queue) {
+        if (attack_obj.tick != get_model().get_time())
+            continue;
+        Truck* target = get_model().resolve<Truck>(attack_obj.target);
+        if (!target)
+            target = get_model().find_truck_by_order(attack_obj.order);
+        try {
+            if (target) {
+                attack(*target);
             }
         }
-        attack_queue.clear();
+        catch (const SimulationException& e) {
+            get_model().get_output() << e.what() << std::endl;
+        }
     }
+    attack_queue.clear();
 }
 
+// Targets are hashed by their registry order, their handles depend on the slot reuse of the process.
+void Chopper::hash_state(State_Hash& hash) const {
+    Vehicle::hash_state(hash);
+    hash.add(range);
+    hash.add(stolen);
+    hash.add(static_cast<std::uint64_t>(attack_queue.size()));
+    for (const auto& attack_obj : attack_queue) {
+        hash.add(static_cast<std::uint64_t>(attack_obj.order));
+        hash.add(attack_obj.tick);
+    }
+}
+
+void Chopper::pack(Shard_Message& message) const {
+    Vehicle::pack(message);
+    message.put(range);
+    message.put(stolen);
+    message.put(static_cast<std::uint32_t>(attack_queue.size()));
+    for (const auto& attack_obj : attack_queue) {
+        message.put(attack_obj.order);
+        message.put(attack_obj.tick);
+    }
+}
@@ -15,23 +15,30 @@
  */
 class Chopper final : public Vehicle{
 public:
-    Chopper(const std::string &name,const Point& pos);
-    Chopper(const std::string &name, double speed, int course,const Point& pos);
+    static constexpr Kind KIND = Chopper_Kind;
+    Chopper(Model& model, const std::string &name,const Point& pos);
+    Chopper(Model& model, const std::string &name, double speed, int course,const Point& pos);
+    Chopper(Model& model, Shard_Message& message);     // Unpack a chopper packed by another world.
 
     void set_destination(const std::string &warehouse_name) override;  // Set chopper destination.
     void set_parameters(double speed, double course) override;         // Set speed and course.
     void set_course(double course) override;                           // Set course.
     void set_position(Point& pos) override;                            // Set position.
-    void broadcast_current_state() const override;                     // Broadcast state.
+    void broadcast_current_state(Status_Text& out) const override;                     // Broadcast state.
 
     void decrease_range();              // Decrease chopper's range.
     void increase_range();              // Increase chopper's range.
     int get_stolen_crates() const;      // Get number of stolen crates.
     void attack(Truck& target);         // Attack a truck.
     bool is_in_range(const Truck& target) const; // Check if the truck is in attack range.
-    void queue_attack(const std::string& target, int time);   // Queue an attack on a truck.
+    void queue_attack(Truck& target, int time);   // Attack a truck now, or queue the attack if out of range.
 
-    void update() override;             // Update chopper state.
+    void end_step() override;           // Run queued attacks while stopped.
+    bool is_dormant() const;            // Stopped with no queued attack.
+    bool has_due_attack(int time) const;    // Will end_step attack at this time?
+    const std::vector<AttackCommand>& get_attack_queue() const;     // Queued attacks.
+    void hash_state(State_Hash& hash) const override;   // Adds range, stolen crates and queued attacks.
+    void pack(Shard_Message& message) const override;   // Adds range, stolen crates and queued attacks.
 
 private:
     double range = 2;                              // Chopper range.
@@ -1,51 +1,64 @@
-#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "Command_Table.h"
 #include "Model.h"
 #include "SimulationException.h"
 
-using CommandFunction = std::function<void(std::vector<std::string>& parameters)>;
-inline std::map<std::string, CommandFunction> buildCommandsMap() {
-    std::map<std::string,CommandFunction> commandsMap;
+// Commands read their arguments as views into the command line, numbers are parsed in place.
+inline Command_Table buildCommandTable(Model& model) {
+    Command_Table commands;
 
     // Create command, check every field given, and call Model for insertion.
     // Throws SimulationException upon bad input.
-    commandsMap["create"] = [&](std::vector<std::string>& parameters) {
+    commands.add("create", [&](const Tokens& parameters) {
         if (parameters.size() < 4) throw InvalidCommandException("Error: Create receives 4-5 arguments");
         if (!is_valid_sim_name(parameters[1])) throw IllegalNameException("Error: Vehicle name is not valid");
 
         if (parameters.size() == 5 && parameters[2] == ROBBER) {    // Chopper found.
-            if (parameters[3].back() == ',') {
-                parameters[3].pop_back();
+            std::string_view left = parameters[3];
+            const std::string_view right = parameters[4];
+            if (left.back() == ',') {
+                left.remove_suffix(1);
             }else
                 throw BadCoordinatesException("Error: Wrong coordinates format");
 
-            if (is_valid_coordinate_pair(parameters[3], parameters[4])) {
-                parameters[3].erase(0,1);
-                parameters[4].erase(parameters[4].size() - 1, 1);
-                const float ix = std::stof(parameters[3]);
-                const float iy = std::stof(parameters[4]);
-                Model::get_instance().create_chopper(parameters[1], ix, iy);    // Call chopper insertion.
+            if (is_valid_coordinate_pair(left, right)) {
+                const auto ix = parse_number<float>(left.substr(1));
+                const auto iy = parse_number<float>(right.substr(0, right.size() - 1));
+                model.create_chopper(std::string(parameters[1]), ix, iy);    // Call chopper insertion.
             }else {
                 throw BadCoordinatesException("Error: Wrong coordinates format");
             }
         }
         else if (parameters.size() == 4 && parameters[2] == POLICE) {   // Trooper found.
-                const auto* warehouse = Model::get_instance().find_warehouse_by_name(parameters[3]);
+                const auto* warehouse = model.find_warehouse_by_name(parameters[3]);
                 if (!warehouse)
                     throw WarehouseNotFoundException("Error: Warehouse not found in database");
-            Model::get_instance().create_trooper(parameters[1], warehouse->get_location(), parameters[3]);  // Call trooper insertion.
+            model.create_trooper(std::string(parameters[1]), warehouse->get_location(), std::string(parameters[3]));  // Call trooper insertion.
         }else {
             throw InvalidCommandFormatException("Error: Wrong command for create");
         }
-    };
+    });
+
+    // Create_bulk command, creates every chopper and trooper of a CSV file in one batch.
+    // Throws SimulationException upon bad input, then nothing is created.
+    commands.add("create_bulk", [&](const Tokens& parameters) {
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Create_bulk receives 1 argument only");
+
+        model.create_bulk(std::string(parameters[1]));
+    });
 
     // Course command, check every field given, and call Model for changes.
     // Throws SimulationException upon bad input.
-    commandsMap["course"] = [&](const std::vector<std::string>& parameters) {
-        Vehicle* target = Model::get_instance().find_vehicle_by_name(parameters[0]);
+    commands.add("course", [&](const Tokens& parameters) {
+        Vehicle* target = model.find_vehicle_by_name(parameters[0]);
         if (!target)
-            throw VehicleNotFoundException("Error: Vehicle <" + parameters[0] + "> not found in database");
+            throw VehicleNotFoundException("Error: Vehicle <" + std::string(parameters[0]) + "> not found in database");
 
-        const auto chopper = dynamic_cast<Chopper*>(target);
+        const auto chopper = sim_cast<Chopper>(target);
         if (chopper) {                  // Chopper found.
             if (parameters.size() != 4)
                 throw InvalidCommandFormatException("Error: Expected 4 parameters for Chopper course command");
@@ -53,15 +66,15 @@ inline std::map<std::string, CommandFunction> buildCommandsMap() {
             if (!is_number(parameters[2]) || !is_number(parameters[3]))
                 throw InvalidArgumentsForTypeException("Error: Speed / Course are not numbers");
 
-            const double course = std::stod(parameters[2]);
-            const double speed = std::stod(parameters[3]);
+            const auto course = parse_number<double>(parameters[2]);
+            const auto speed = parse_number<double>(parameters[3]);
             if (course >= 0 && course <= 360) {
-                Model::get_instance().set_chopper_course_and_speed(parameters[0], course, speed);   // Set speed and course.
+                model.set_chopper_course_and_speed(std::string(parameters[0]), course, speed);   // Set speed and course.
                 return;
             }
             throw InvalidArgumentException("Error: Course is invalid");
         }
-        const auto trooper = dynamic_cast<StateTrooper*>(target);
+        const auto trooper = sim_cast<StateTrooper>(target);
         if (trooper) {                  // Trooper found.
             if (parameters.size() != 3)
                 throw InvalidCommandFormatException("Error: Expected 3 parameters for Trooper course command");
@@ -69,51 +82,50 @@ inline std::map<std::string, CommandFunction> buildCommandsMap() {
             if (!is_number(parameters[2]))
                 throw InvalidArgumentsForTypeException("Error: Course is not a number");
 
-            const double course = std::stod(parameters[2]);
+            const auto course = parse_number<double>(parameters[2]);
             if (course >= 0 && course <= 360) {
-                Model::get_instance().set_trooper_course(parameters[0], course);        // Set course for trooper.
+                model.set_trooper_course(std::string(parameters[0]), course);        // Set course for trooper.
                 return;
             }
             throw InvalidArgumentException("Error: Course is invalid");
         }
         throw InvalidCommandFormatException("Error: Wrong command for course");
-    };
+    });
 
     // Position command, check every field given, and change fields in place.
     // Throws SimulationException upon bad input.
-    commandsMap["position"] = [&](std::vector<std::string>& parameters) {
+    commands.add("position", [&](const Tokens& parameters) {
         if (parameters.size() < 4)
             throw InvalidCommandFormatException("Error: Not enough parameters for position command");
 
-        const Model& model = Model::get_instance();
         Vehicle* target = model.find_vehicle_by_name(parameters[0]);
         if (!target)
-            throw VehicleNotFoundException("Error: Vehicle <" + parameters[0] + "> not found in database");
+            throw VehicleNotFoundException("Error: Vehicle <" + std::string(parameters[0]) + "> not found in database");
 
-        if (parameters[2].back() != ',')
+        std::string_view left = parameters[2];
+        const std::string_view right = parameters[3];
+        if (left.back() != ',')
             throw BadCoordinatesException("Error: Wrong coordinates format");
 
-        parameters[2].pop_back();
-        if (!(is_valid_coordinate_pair(parameters[2], parameters[3])))
+        left.remove_suffix(1);
+        if (!(is_valid_coordinate_pair(left, right)))
             throw BadCoordinatesException("Error: Wrong coordinates format");
 
-        parameters[2].erase(0, 1);
-        parameters[3].erase(parameters[3].size() - 1, 1);
-        const float x = std::stof(parameters[2]);
-        const float y = std::stof(parameters[3]);
+        const auto x = parse_number<float>(left.substr(1));
+        const auto y = parse_number<float>(right.substr(0, right.size() - 1));
         Point pos(x, y);
 
         if (parameters.size() == 4) {                           // Truck or trooper.
-            if (auto* truck = dynamic_cast<Truck*>(target))
+            if (auto* truck = sim_cast<Truck>(target))
                 truck->set_position(pos);
-            else if (auto* trooper = dynamic_cast<StateTrooper*>(target))
+            else if (auto* trooper = sim_cast<StateTrooper>(target))
                 trooper->set_position(pos);                 // Set position.
             else
                 throw InvalidArgumentsForTypeException("Error: Vehicle is not Truck or StateTrooper");
         }
         else if (parameters.size() == 5 && is_number(parameters[4])) {  // Chopper.
-                if (auto* chopper = dynamic_cast<Chopper*>(target)) {
-                    const double speed = std::stod(parameters[4]);
+                if (auto* chopper = sim_cast<Chopper>(target)) {
+                    const auto speed = parse_number<double>(parameters[4]);
                     if (speed >= 0 && speed <= 170) {
                         chopper->set_speed(speed);
                         chopper->set_position(pos);                 // Set speed and position.
@@ -128,131 +140,279 @@ inline std::map<std::string, CommandFunction> buildCommandsMap() {
         else
             throw InvalidCommandFormatException("Error: Wrong command format for position");
 
-        };
+    });
 
     // Destination command, trooper only command, call Model for changes.
     // Throws SimulationException upon bad input.
-    commandsMap["destination"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("destination", [&](const Tokens& parameters) {
         if (parameters.size() != 3)
             throw InvalidCommandFormatException("Error: Destination receives 2 arguments");
 
-        Model::get_instance().set_trooper_destination(parameters[0], parameters[2]);
-    };
+        model.set_trooper_destination(std::string(parameters[0]), std::string(parameters[2]));
+    });
 
     // Attack command, check every field given, and attack a truck if possible via Model.
     // Otherwise, queue the attack for the time tick.
     // Throws SimulationException upon bad input.
-    commandsMap["attack"] = [&](const std::vector<std::string> &parameters) {
+    commands.add("attack", [&](const Tokens& parameters) {
         if (parameters.size() != 3)
             throw InvalidCommandFormatException("Error: Attack receives 2 arguments");
 
-        const Chopper* chopper = Model::get_instance().find_chopper_by_name(parameters[0]);
-        const Truck* truck = Model::get_instance().find_truck_by_name(parameters[2]);
+        const Chopper* chopper = model.find_chopper_by_name(parameters[0]);
+        const Truck* truck = model.find_truck_by_name(parameters[2]);
         if (!chopper)
             throw NotFoundException("Error: Chopper not found");
 
         if (!truck)
             throw NotFoundException("Error: Truck not found");
 
-        Model::get_instance().queue_attack(parameters[0],parameters[2]);
-    };
+        model.queue_attack(std::string(parameters[0]), std::string(parameters[2]));
+    });
 
     // Stop command, check the existence of a vehicle via Model, if exists stop the vehicle.
     // Throws SimulationException upon bad input.
-    commandsMap["stop"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("stop", [&](const Tokens& parameters) {
         if (parameters.size() != 2)
             throw InvalidCommandFormatException("Error: Size receives 1 argument only");
 
-        Model::get_instance().stop_vehicle(parameters[0]);
-    };
+        model.stop_vehicle(std::string(parameters[0]));
+    });
 
     // Go command, updates every object inside the Model via one tick time.
     // Throws SimulationException upon bad input.
-    commandsMap["go"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("go", [&](const Tokens& parameters) {
         if (parameters.size() != 1)
             throw InvalidCommandFormatException("Error: Go receives 0 arguments");
 
-        Model::get_instance().update();
-    };
+        model.update();
+    });
+
+    // Tick command, sets the sub-step length in minutes that every go is divided into.
+    // Throws SimulationException upon bad input.
+    commands.add("tick", [&](const Tokens& parameters) {
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Tick receives 1 argument only");
+
+        if (!is_number(parameters[1]) || parameters[1].find('.') != std::string_view::npos)
+            throw InvalidArgumentException("Error: Tick expects a whole number of minutes");
+
+        model.set_tick_minutes(parse_number<int>(parameters[1]));
+    });
+
+    // Record command, records every step of every vehicle into a telemetry file, "record off" stops.
+    // Throws SimulationException upon bad input.
+    commands.add("record", [&](const Tokens& parameters) {
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Record receives 1 argument only");
+
+        if (parameters[1] == "off")
+            model.stop_recording();
+        else
+            model.start_recording(std::string(parameters[1]));
+    });
+
+    // Serve command, answers status queries from a snapshot published after every tick on a Unix socket,
+    // "serve off" closes it. Throws SimulationException upon bad input.
+    commands.add("serve", [&](const Tokens& parameters) {
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Serve receives 1 argument only");
+
+        if (parameters[1] == "off")
+            model.stop_query_server();
+        else
+            model.start_query_server(std::string(parameters[1]));
+    });
+
+    // Feed command, publishes positions, types and statuses of all objects into a POSIX shared memory
+    // segment after every step, "feed off" removes it. Throws SimulationException upon bad input.
+    commands.add("feed", [&](const Tokens& parameters) {
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Feed receives 1 argument only");
+
+        if (parameters[1] == "off")
+            model.stop_feed();
+        else
+            model.start_feed(std::string(parameters[1]));
+    });
+
+    // Checksum command, prints a hash of the whole world state, "checksum <file>" logs it after every step,
+    // "checksum off" closes the log. Throws SimulationException upon bad input.
+    commands.add("checksum", [&](const Tokens& parameters) {
+        if (parameters.size() == 1) {
+            std::ostringstream line;
+            line << "Checksum at time " << model.get_time() << ": " << std::hex << std::setfill('0')
+                 << std::setw(16) << model.checksum();
+            model.get_output() << line.str() << std::endl;
+            return;
+        }
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Checksum receives at most 1 argument");
+
+        if (parameters[1] == "off")
+            model.stop_checksum_log();
+        else
+            model.start_checksum_log(std::string(parameters[1]));
+    });
+
+    // Output command, routes all simulation output into a sink: "output stdout", "output null",
+    // "output async" (written on a background thread), "output file <path>" or "output ring <bytes>"
+    // (keeps the last bytes in memory, printed when the next sink replaces it). Throws SimulationException upon bad input.
+    commands.add("output", [&](const Tokens& parameters) {
+        if (parameters.size() == 2 && parameters[1] == "stdout")
+            model.set_sink(nullptr);
+        else if (parameters.size() == 2 && parameters[1] == "null")
+            model.set_sink(std::make_unique<Null_Sink>());
+        else if (parameters.size() == 2 && parameters[1] == "async")
+            model.set_sink(std::make_unique<Async_Sink>(std::cout.rdbuf()));
+        else if (parameters.size() == 3 && parameters[1] == "file")
+            model.set_sink(std::make_unique<File_Sink>(std::string(parameters[2])));
+        else if (parameters.size() == 3 && parameters[1] == "ring") {
+            if (!is_number(parameters[2]) || parameters[2].find('.') != std::string_view::npos)
+                throw InvalidArgumentException("Error: Ring size must be a whole number of bytes");
+            const auto bytes = parse_number<std::size_t>(parameters[2]);
+            if (bytes > RING_OUTPUT_LIMIT)
+                throw InvalidArgumentException("Error: Ring size must be at most " + std::to_string(RING_OUTPUT_LIMIT) + " bytes");
+            model.set_sink(std::make_unique<Ring_Sink>(bytes));
+        } else
+            throw InvalidCommandFormatException("Error: Output receives stdout, null, async, file <path> or ring <bytes>");
+    });
+
+    // Archive command, retires finished (stopped or robbed) trucks from the live world: "archive age <hours>"
+    // once they are finished for the hours, "archive count <n>" beyond the n most recent, "archive file <path>"
+    // keeps the archive in a file, "archive off" stops archiving. Throws SimulationException upon bad input.
+    commands.add("archive", [&](const Tokens& parameters) {
+        if (parameters.size() == 2 && parameters[1] == "off") {
+            model.stop_archiving();
+            return;
+        }
+        if (parameters.size() != 3)
+            throw InvalidCommandFormatException("Error: Archive receives age <hours>, count <n>, file <path> or off");
+
+        if (parameters[1] == "file") {
+            model.spill_archive(std::string(parameters[2]));
+            return;
+        }
+        if (!is_number(parameters[2]) || parameters[2].find('.') != std::string_view::npos)
+            throw InvalidArgumentException("Error: Archive " + std::string(parameters[1]) + " must be a whole number");
+        if (parameters[1] == "age")
+            model.set_archive_age(parse_number<int>(parameters[2]));
+        else if (parameters[1] == "count")
+            model.set_archive_limit(parse_number<std::size_t>(parameters[2]));
+        else
+            throw InvalidCommandFormatException("Error: Archive receives age <hours>, count <n>, file <path> or off");
+    });
+
+    // Proximity command, "proximity <type> <type> <radius>" reports vehicles of the two types entering
+    // and leaving the radius of each other after every step, "proximity off" removes every pair.
+    // Throws SimulationException upon bad input.
+    commands.add("proximity", [&](const Tokens& parameters) {
+        if (parameters.size() == 2 && parameters[1] == "off") {
+            model.clear_proximity_rules();
+            return;
+        }
+        if (parameters.size() != 4)
+            throw InvalidCommandFormatException("Error: Proximity receives 3 arguments or off");
+        if (!is_number(parameters[3]))
+            throw InvalidArgumentException("Error: Radius is not a number");
+
+        model.add_proximity_rule(std::string(parameters[1]), std::string(parameters[2]),
+                                 parse_number<double>(parameters[3]));
+    });
 
     // Status command, receives no arguments, activates the broadcast_status function on
     // Every object inside the Model.
     // Throws SimulationException upon bad input.
-    commandsMap["status"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("status", [&](const Tokens& parameters) {
+        if (parameters.size() == 2 && parameters[1] == "--all") {     // Archived trucks after the live objects.
+            model.broadcast_status();
+            model.broadcast_archive();
+            return;
+        }
         if (parameters.size() != 1)
-            throw InvalidCommandFormatException("Error: Status receives 0 arguments");
+            throw InvalidCommandFormatException("Error: Status receives 0 arguments or --all");
 
-        Model::get_instance().broadcast_status();
-    };
+        model.broadcast_status();
+    });
 
     // Default command, changes the View fields into the default configuration.
     // Throws SimulationException upon bad input.
-    commandsMap["default"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("default", [&](const Tokens& parameters) {
         if (parameters.size() != 1)
             throw InvalidCommandFormatException("Error: Default receives 0 arguments");
 
-        for (const auto& view : Model::get_instance().get_view_list()) {
+        for (const auto& view : model.get_view_list()) {
             view->defaults();
         }
-    };
+    });
 
     // Size command, changes the size field of the View.
     // Throws SimulationException upon bad input.
-    commandsMap["size"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("size", [&](const Tokens& parameters) {
         if (parameters.size() != 2)
             throw InvalidCommandFormatException("Error: Size receives 1 argument only");
 
         if (is_number(parameters[1])) {
-            const int new_size = std::stoi(parameters[1]);
-            for (const auto& view : Model::get_instance().get_view_list()) {
+            const auto new_size = parse_number<int>(parameters[1]);
+            for (const auto& view : model.get_view_list()) {
                 view->set_size(new_size);
             }
         }
         else
             throw InvalidArgumentException("Error: Argument is not a number");
-    };
+    });
 
     // Zoom command, changes the scale field of the View.
     // Throws SimulationException upon bad input.
-    commandsMap["zoom"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("zoom", [&](const Tokens& parameters) {
         if (parameters.size() != 2)
             throw InvalidCommandFormatException("Error: Zoom receives 1 argument only");
 
         if (!is_number(parameters[1]))
             throw InvalidArgumentException("Error: Zoom expects a double");
 
-        const double new_zoom = std::stod(parameters[1]);
-        for (const auto& view : Model::get_instance().get_view_list()) {
+        const auto new_zoom = parse_number<double>(parameters[1]);
+        for (const auto& view : model.get_view_list()) {
             view->zoom(new_zoom);
         }
-    };
+    });
 
     // Pan command, changes the pan of the map inside View.
     // Throws SimulationException upon bad input.
-    commandsMap["pan"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("pan", [&](const Tokens& parameters) {
         if (parameters.size() != 3)
             throw InvalidCommandFormatException("Error: Pan receives 2 coordinates only");
 
         if (!(is_number(parameters[1]) && is_number(parameters[2])))
             throw InvalidArgumentException("Error: Pan receives 2 doubles");
 
-        const float x = std::stof(parameters[1]);
-        const float y = std::stof(parameters[2]);
+        const auto x = parse_number<float>(parameters[1]);
+        const auto y = parse_number<float>(parameters[2]);
         const Point p(x, y);
 
-        for (const auto& view : Model::get_instance().get_view_list()) {
+        for (const auto& view : model.get_view_list()) {
             view->pan(p);
         }
-    };
+    });
+
+    // Density command, "density on" draws per cell type and count instead of name labels, "density off" returns.
+    // Throws SimulationException upon bad input.
+    commands.add("density", [&](const Tokens& parameters) {
+        if (parameters.size() != 2 || (parameters[1] != "on" && parameters[1] != "off"))
+            throw InvalidCommandFormatException("Error: Density receives on or off");
+
+        for (const auto& view : model.get_view_list()) {
+            view->set_density(parameters[1] == "on");
+        }
+    });
 
     // Show command, prints the map of the game inside the console.
     // Throws SimulationException upon bad input.
-    commandsMap["show"] = [&](const std::vector<std::string>& parameters) {
+    commands.add("show", [&](const Tokens& parameters) {
        if (parameters.size() != 1)
            throw InvalidCommandFormatException("Error: Show receives 0 arguments");
 
-       Model::get_instance().notify_views();
-    };
+       model.notify_views();
+    });
 
-    return commandsMap;
+    return commands;
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "Command_Table.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Same separators as reading words from a stream.
+static bool is_separator(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+bool tokenize(const std::string_view line, Tokens& tokens) {
+    tokens.count = 0;
+    std::size_t i = 0;
+    while (true) {
+        while (i < line.size() && is_separator(line[i])) ++i;
+        if (i == line.size()) return true;
+        const std::size_t start = i;
+        while (i < line.size() && !is_separator(line[i])) ++i;
+        if (tokens.count == MAX_COMMAND_TOKENS) return false;
+        tokens.items[tokens.count++] = line.substr(start, i - start);
+    }
+}
+
+void Command_Table::add(const std::string_view name, CommandFunction function) {
+    if (std::find(COMMAND_NAMES.begin(), COMMAND_NAMES.end(), name) == COMMAND_NAMES.end())
+        throw std::logic_error("Command <" + std::string(name) + "> is not in COMMAND_NAMES");
+    entries[command_slot(name)] = {name, std::move(function)};
+}
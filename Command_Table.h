@@ -0,0 +1,98 @@
+#ifndef COMMAND_TABLE_H
+#define COMMAND_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+#define MAX_COMMAND_TOKENS 5                                // Longest command: "<name> position (x, y) speed".
+#define COMMAND_TABLE_SIZE 64                               // Dispatch table slots, a power of two.
+
+/**
+ * Tokens struct
+ * Whitespace separated words of one command line, viewed in place without copying.
+ * The line must outlive the tokens.
+ */
+struct Tokens {
+    std::array<std::string_view, MAX_COMMAND_TOKENS> items; // Words of the line.
+    std::size_t count = 0;                                  // Words used.
+
+    std::size_t size() const { return count; }
+    std::string_view operator[](const std::size_t i) const { return items[i]; }
+};
+
+// Function that splits a line on whitespace into tokens.
+// Returns false if the line holds more than MAX_COMMAND_TOKENS words.
+bool tokenize(std::string_view line, Tokens& tokens);
+
+using CommandFunction = std::function<void(const Tokens& parameters)>;
+
+// Every command keyword, each one hashes to its own slot of the table.
+constexpr std::array<std::string_view, 23> COMMAND_NAMES = {
+    "create", "create_bulk", "course", "position", "destination", "attack", "stop", "go",
+    "tick", "status", "default", "size", "zoom", "pan", "show", "record", "density", "proximity", "serve",
+    "feed", "checksum", "output", "archive"
+};
+
+// Seeded FNV-1a of a word, the high half is folded in since the low bits alone depend on few seed bits.
+constexpr std::uint32_t command_hash(const std::string_view word, const std::uint32_t seed) {
+    std::uint32_t hash = 2166136261u ^ seed;
+    for (const char c : word) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 16);
+}
+
+// One hash per keyword, a slot taken twice rejects the seed.
+constexpr bool command_seed_is_perfect(const std::uint32_t seed) {
+    std::array<bool, COMMAND_TABLE_SIZE> taken{};
+    for (const auto name : COMMAND_NAMES) {
+        const std::size_t slot = command_hash(name, seed) & (COMMAND_TABLE_SIZE - 1);
+        if (taken[slot])
+            return false;
+        taken[slot] = true;
+    }
+    return true;
+}
+
+// First seed that gives every keyword its own slot, searched by the compiler.
+constexpr std::uint32_t find_command_seed() {
+    for (std::uint32_t seed = 0; seed < 4096; ++seed)
+        if (command_seed_is_perfect(seed))
+            return seed;
+    return UINT32_MAX;
+}
+
+constexpr std::uint32_t COMMAND_SEED = find_command_seed();
+static_assert(COMMAND_SEED != UINT32_MAX, "No perfect hash seed for the command keywords, grow COMMAND_TABLE_SIZE");
+
+// Perfect hash of the keywords above, any other word still needs a compare against the slot name.
+constexpr std::size_t command_slot(const std::string_view word) {
+    return command_hash(word, COMMAND_SEED) & (COMMAND_TABLE_SIZE - 1);
+}
+
+/**
+ * Command_Table class
+ * Dispatch table of the commands, a lookup is one hash and one compare.
+ */
+class Command_Table {
+public:
+    void add(std::string_view name, CommandFunction function);  // Register a keyword from COMMAND_NAMES.
+
+    const CommandFunction* find(const std::string_view word) const {    // Null if the word is not a command.
+        const Entry& entry = entries[command_slot(word)];
+        return entry.function && entry.name == word ? &entry.function : nullptr;
+    }
+
+private:
+    struct Entry {
+        std::string_view name;                              // Keyword stored in this slot.
+        CommandFunction function;                           // Command, empty if the slot is unused.
+    };
+    std::array<Entry, COMMAND_TABLE_SIZE> entries;          // Slots by command_slot().
+};
+
+#endif //COMMAND_TABLE_H
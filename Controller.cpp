@@ -1,6 +1,20 @@
 #include "Controller.h"
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include "SimulationException.h"
+#include "Sweep.h"
+
+#define USAGE "Usage: –w depot.dat –t <truckfile1> [<truckfile2> <truckfile3> ...] [-c <bundle>] [-l <command_log>] [-s <sweep_file>] [-r <regions>]\n" \
+              "       -b <bundle> [-l <command_log>] [-s <sweep_file>] [-r <regions>]"
+
+Controller::Controller(Model& _model) : model(_model) {}
+
+// "run" with any arguments, a bare "run" reaches run_realtime too and gets its usage error.
+static bool is_run_command(const std::string& command) {
+    Tokens tokens;
+    return tokenize(command, tokens) && tokens.size() > 0 && tokens[0] == "run";
+}
 
 void Controller::run(const int argc, char *argv[]) {
     std::cerr.rdbuf(std::cout.rdbuf());             // All cerr goes to cout, Eliminates print delay.
@@ -11,61 +25,248 @@ void Controller::run(const int argc, char *argv[]) {
         std::cerr << e.what() << std::endl; // On any error, exit.
         exit(1);
     }
-    std::string command;
+    if (!bundle_file.empty()) {             // Compile mode, the inputs are validated, write the bundle.
+        try {
+            model.compile_bundle(bundle_file);
+        } catch (const SimulationException& e) {
+            std::cerr << e.what() << std::endl;
+            exit(1);
+        }
+        std::cout << "Compiled scenario bundle <" << bundle_file << ">" << std::endl;
+        return;
+    }
+    if (!sweep_file.empty()) {              // Sweep mode, no prompt.
+        try {
+            Sweep sweep(model.get_scenario());
+            sweep.load(sweep_file);
+            sweep.run();
+            sweep.print_summary(std::cout);
+        } catch (const SimulationException& e) {
+            std::cerr << e.what() << std::endl;
+            exit(1);
+        }
+        return;
+    }
+    std::thread reader(&Controller::read_input, this);   // Input runs beside the simulation.
     while (true) {
-        std::cout << "Time " << Model::get_instance().get_time() << ": Enter command: ";
-        std::getline(std::cin, command);
+        model.get_output() << "Time " << model.get_time() << ": Enter command: " << std::flush;
+        const std::string command = next_command();
+        log_command(command);
         if (command == "exit") break;
+        if (is_run_command(command)) {              // Clocked mode, until pause or exit.
+            if (!run_realtime(command)) break;
+            continue;
+        }
         execute(command);                   // Execute user commands.
     }
+    reader.join();
 }
 
-void Controller::load(const int argc, char * argv[]) {
-    if (argc < 4 || std::string(argv[1]) != "-w") {
-        throw InvalidFileArgumentsException("Usage: –w depot.dat –t <truckfile1> [<truckfile2> <truckfile3> ...]");
+// run <speedup> [hours]: one simulated hour every MS_PER_SIM_HOUR / speedup real milliseconds.
+// Deadlines are absolute, so time spent in a tick does not drift the clock, a late tick is reported
+// and the following ticks run back to back until the clock is caught up.
+bool Controller::run_realtime(const std::string& command) {
+    using clock = std::chrono::steady_clock;
+    double speedup;
+    long hours = -1;                // Negative runs until pause or exit.
+    try {
+        Tokens tokens;
+        if (!tokenize(command, tokens) || tokens.size() < 2 || tokens.size() > 3)
+            throw InvalidCommandFormatException("Error: Run receives 1-2 arguments");
+        if (!is_number(tokens[1]) || parse_number<double>(tokens[1]) <= 0)
+            throw InvalidArgumentException("Error: Speedup must be a positive number");
+        speedup = parse_number<double>(tokens[1]);
+        if (tokens.size() == 3) {
+            if (!is_number(tokens[2]) || tokens[2].find('.') != std::string_view::npos ||
+                parse_number<long>(tokens[2]) <= 0)
+                throw InvalidArgumentException("Error: Hours must be a positive whole number");
+            hours = parse_number<long>(tokens[2]);
+        }
+    } catch (const SimulationException& e) {
+        model.get_output() << e.what() << std::endl;
+        return true;
+    }
+
+    const auto period = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double, std::milli>(MS_PER_SIM_HOUR / speedup));
+    const double budget_ms = std::chrono::duration<double, std::milli>(period).count();
+    std::ostream& out = model.get_output();
+    out << "Running, one hour every " << budget_ms << " ms" << std::endl;
+
+    auto deadline = clock::now() + period;
+    for (long done = 0; hours < 0 || done < hours; ++done) {
+        // Apply everything queued since the previous tick.
+        std::string queued;
+        while (commands.try_pop(queued)) {
+            log_command(queued);
+            if (queued == "exit") return false;
+            if (queued == "pause") {
+                out << "Paused at time " << model.get_time() << std::endl;
+                return true;
+            }
+            if (is_run_command(queued)) {
+                out << "Error: Simulation is already running" << std::endl;
+                continue;
+            }
+            execute(queued);
+        }
+
+        std::this_thread::sleep_until(deadline);
+        const auto start = clock::now();
+        try {
+            advance();
+        } catch (const SimulationException& e) {      // A region worker failed, back to the prompt.
+            out << e.what() << std::endl;
+            return true;
+        }
+        const auto end = clock::now();
+
+        if (end > deadline + period) {
+            const double took_ms = std::chrono::duration<double, std::milli>(end - start).count();
+            const double late_ms = std::chrono::duration<double, std::milli>(end - deadline - period).count();
+            out << "Overrun at time " << model.get_time() << ": tick took " << took_ms
+                << " ms, budget " << budget_ms << " ms, " << late_ms << " ms behind" << std::endl;
+        }
+        deadline += period;
+    }
+    return true;
+}
+
+// Reads lines until "exit" or end of input, end of input is treated as "exit".
+void Controller::read_input() {
+    std::string line;
+    while (true) {
+        if (!std::getline(std::cin, line))
+            line = "exit";
+        const bool last = line == "exit";
+        while (!commands.try_push(std::move(line)))     // Queue full, wait for the simulation.
+            std::this_thread::yield();
+        {
+            std::lock_guard<std::mutex> lock(input_mutex);  // Orders the push before a waiting check.
+        }
+        input_ready.notify_one();
+        if (last) return;
     }
-    const std::string depot_file = argv[2];
+}
+
+// Commands are applied in the order they were read, only between ticks. With nothing queued the
+// prompt blocks until the reader signals, the queue check runs under the lock so no signal is lost.
+std::string Controller::next_command() {
+    std::string command;
+    while (!commands.try_pop(command)) {
+        std::unique_lock<std::mutex> lock(input_mutex);
+        input_ready.wait(lock, [this] { return !commands.empty(); });
+    }
+    return command;
+}
+
+// Log line: "<sequence> <time> <command>", time is the tick the command was applied after.
+void Controller::log_command(const std::string& command) {
+    ++command_count;
+    if (command_log.is_open())
+        command_log << command_count << " " << model.get_time() << " " << command << '\n';
+}
+
+// Either the depot and truck files (-w, -t), or a bundle compiled from them (-b).
+// With regions the coordinator keeps only the warehouses, the workers create the trucks.
+void Controller::load(const int argc, char * argv[]) {
+    if (argc < 3)
+        throw InvalidFileArgumentsException(USAGE);
+    const std::string first_flag = argv[1];
     std::vector<std::string> truck_files;
-    if (std::string(argv[3]) == "-t") {
-        for (int i = 4; i < argc; ++i)
+    int i = 3;
+    if (first_flag == "-w") {
+        if (argc < 4 || std::string(argv[3]) != "-t")
+            throw InvalidFlagsException(USAGE);
+        for (i = 4; i < argc && argv[i][0] != '-'; ++i)
             truck_files.emplace_back(argv[i]);
-    } else {
-        throw InvalidFlagsException("Usage: –w depot.dat –t <truckfile1> [<truckfile2> <truckfile3> ...]");
+    } else if (first_flag != "-b") {
+        throw InvalidFileArgumentsException(USAGE);
     }
+    // Optional flags after the input files, each takes one argument.
+    for (; i < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (i + 1 >= argc)
+            throw InvalidFlagsException(USAGE);
+        if (flag == "-l") {
+            command_log.open(argv[i + 1]);
+            if (!command_log.is_open())
+                throw FileException("Error: Could not open file <" + std::string(argv[i + 1]) + ">");
+        } else if (flag == "-s") {
+            sweep_file = argv[i + 1];
+        } else if (flag == "-c" && first_flag == "-w") {
+            bundle_file = argv[i + 1];
+        } else if (flag == "-r") {
+            const std::string_view count = argv[i + 1];
+            if (!is_number(count) || count.find('.') != std::string_view::npos ||
+                parse_number<long>(count) < 1 || parse_number<long>(count) > MAX_REGIONS)
+                throw InvalidFlagsException("Error: Regions must be a whole number from 1 to " + std::to_string(MAX_REGIONS));
+            regions = parse_number<std::size_t>(count);
+        } else {
+            throw InvalidFlagsException(USAGE);
+        }
+    }
+    if (regions > 0 && (!sweep_file.empty() || !bundle_file.empty()))
+        throw InvalidFlagsException("Error: Regions run the prompt, they do not combine with -s or -c");
+
+    std::vector<double> origins;        // Truck origins split the map into regions of equal load.
+    if (regions > 0)
+        model.set_truck_filter([&](const Point& origin) {
+            origins.push_back(origin.x);
+            return false;
+        });
     // Load all files from the model after receiving the correct flags.
-    Model& model = Model::get_instance();
-    model.load_depot_file(depot_file);
-    for (const auto& tf : truck_files)
-        model.load_truck_file(tf);
+    if (first_flag == "-b") {
+        model.load_bundle(argv[2]);
+    } else {
+        model.load_depot_file(argv[2]);
+        for (const auto& tf : truck_files)
+            model.load_truck_file(tf);
+    }
+    if (regions == 0)
+        return;
+    model.set_truck_filter(nullptr);
+    if (origins.empty())
+        for (const Warehouse* warehouse : model.get_warehouses())
+            origins.push_back(warehouse->get_location().x);
+    coordinator = std::make_unique<Shard_Coordinator>(model, Region_Map(std::move(origins), regions));
+    coordinator->install(commandTable);
+}
+
+void Controller::advance() {
+    if (coordinator)
+        coordinator->go();
+    else
+        model.update();
 }
 
 void Controller::execute(const std::string & command) {
     try {
-        if (command.empty()) throw InvalidCommandException("Error: Command is empty");
+        apply(command);
+    }catch (SimulationException& e) {
+        model.get_output() << e.what() <<  std::endl;
+    }
+}
 
-        std::stringstream stream(command);
-        std::vector<std::string> tokens;
-        std::string token;
-        while (stream >> token)         // Tokenize the command
-            tokens.push_back(token);
+void Controller::apply(const std::string_view command) {
+    if (command.empty()) throw InvalidCommandException("Error: Command is empty");
 
-        if (tokens.size() > 5) {
-            throw InvalidCommandException("Error: Command contains too many arguments");
-        }
+    Tokens tokens;
+    if (!tokenize(command, tokens))     // Tokenize the command in place.
+        throw InvalidCommandException("Error: Command contains too many arguments");
+    if (tokens.size() == 0)
+        throw InvalidCommandException("Error: Command is empty");
 
-        const auto command_at_token0 = commandsMap.find(tokens[0]);
-        const auto command_at_token1 = (tokens.size() > 1) ? commandsMap.find(tokens[1]) : commandsMap.end();
+    const CommandFunction* command_at_token0 = commandTable.find(tokens[0]);
+    const CommandFunction* command_at_token1 = tokens.size() > 1 ? commandTable.find(tokens[1]) : nullptr;
 
-        if (command_at_token0 != commandsMap.end()) {       // Command is at token 0 (create, show...)
-            command_at_token0->second(tokens);
-        }
-        else if (command_at_token1 != commandsMap.end()) {  // Command is at token 1 (position, course...)
-            command_at_token1->second(tokens);
-        }else {
-            throw InvalidCommandException("Error: Command not found");
-        }
-    }catch (SimulationException& e) {
-        std::cerr << e.what() <<  std::endl;
+    if (command_at_token0) {            // Command is at token 0 (create, show...)
+        (*command_at_token0)(tokens);
+    }
+    else if (command_at_token1) {       // Command is at token 1 (position, course...)
+        (*command_at_token1)(tokens);
+    }else {
+        throw InvalidCommandException("Error: Command not found");
     }
 }
 
@@ -1,25 +1,56 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
-#include <map>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <fstream>
 #include "CommandGenerator.cpp"
+#include "SPSC_Queue.h"
+#include "Shard_Coordinator.h"
+
+#define COMMAND_QUEUE_CAPACITY 1024
+#define MS_PER_SIM_HOUR 3600000.0       // Real milliseconds in one simulated hour at speedup 1.
+#define MAX_REGIONS 64                  // Most region worker processes (-r).
 
 /**
  * Controller class,
  * This class is responsible for controlling the Model and View according to interactions
  * with the user.
+ * User input is read on its own thread and handed to the simulation thread through a lock-free queue.
+ * An idle prompt sleeps on a condition variable until the input thread pushes a line.
+ * In clocked mode (run) the Model advances on a wall-clock timer and queued commands are applied between ticks.
+ * With regions (-r) the world is split between worker processes, see Shard_Coordinator.
 */
 class Controller {
 public:
-    Controller() = default;                     // Default constructor.
+    explicit Controller(Model& _model = Model::get_instance());  // Constructor, controls the given world.
     ~Controller();                              // Destructor.
 
     void run(int argc, char *argv[]);           // Run simulation.
     void load(int argc, char * argv[]);         // Load data.
-    void execute(const std::string& command);   // Execute a given command.
+    void execute(const std::string& command);   // Execute a given command, errors are printed.
+    void apply(std::string_view command);       // Execute a given command, throws SimulationException.
 
 private:
-    std::map<std::string, CommandFunction> commandsMap = buildCommandsMap(); // Map command strings to functions.
+    void read_input();                          // Input thread, pushes every line into the queue.
+    std::string next_command();                 // Simulation thread, waits for the next queued line.
+    void log_command(const std::string& command);   // Record the command with the time it was applied.
+    bool run_realtime(const std::string& command);  // Clocked mode, returns false if exit was requested.
+    void advance();                             // Advance the world by one hour.
+
+    Model& model;                               // World controlled by this controller.
+    Command_Table commandTable = buildCommandTable(model);                  // Command keywords to functions.
+    SPSC_Queue<std::string, COMMAND_QUEUE_CAPACITY> commands;               // Lines read, not yet applied.
+    std::mutex input_mutex;                     // Guards the idle wait for input, not the queue.
+    std::condition_variable input_ready;        // Signalled after every pushed line.
+    std::ofstream command_log;                  // Optional log of applied commands (-l).
+    std::string sweep_file;                     // Optional sweep of variants (-s), replaces the prompt.
+    std::string bundle_file;                    // Optional bundle to compile the inputs into (-c), replaces the prompt.
+    std::size_t regions = 0;                    // Region worker processes (-r), 0 runs a single world.
+    std::unique_ptr<Shard_Coordinator> coordinator; // Coordinator of the regions, if any.
+    long command_count = 0;                     // Sequence number of applied commands.
 };
 #endif //CONTROLLER_H
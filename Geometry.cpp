@@ -56,8 +56,8 @@ Point::Point(){
 	y = 0.0;
 }
 
-void Point::print() const{
-	cout << setprecision(2) << "(" << x << ", " << y << ")";
+void Point::print(ostream& out) const{
+	out << setprecision(2) << "(" << x << ", " << y << ")";
 }
 
 bool Point::operator==(const Point & rhs) const{
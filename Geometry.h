@@ -2,6 +2,7 @@
 #define GEOMETRY_H
 
 #include <ctgmath>
+#include <ostream>
 
 /**
  * Geometry utilities and structures
@@ -21,7 +22,7 @@ typedef struct Point {
 	double y;
 	Point(double x, double y);
 	Point();
-	void print() const;
+	void print(ostream& out) const;
 	bool operator==(const Point& rhs) const;
 } Point;
 
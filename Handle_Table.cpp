@@ -0,0 +1,43 @@
+#include "Handle_Table.h"
+
+// Slot 0 stays empty so the zero handle never resolves.
+Handle Handle_Table::insert(Sim_Obj* obj) {
+    if (slots.empty())
+        slots.emplace_back();
+    std::uint32_t index;
+    if (!free_slots.empty()) {
+        index = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        index = static_cast<std::uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    slots[index].obj = obj;
+    ++live;
+    const Handle handle{index, slots[index].generation};
+    obj->set_handle(handle);
+    return handle;
+}
+
+void Handle_Table::release(const Handle handle) {
+    if (!get(handle))
+        return;
+    Slot& slot = slots[handle.index];
+    slot.obj->set_handle({});
+    slot.obj = nullptr;
+    if (++slot.generation == 0)     // Generation 0 is the null handle, skip it on wrap around.
+        slot.generation = 1;
+    free_slots.push_back(handle.index);
+    --live;
+}
+
+Sim_Obj* Handle_Table::get(const Handle handle) const {
+    if (handle.index >= slots.size())
+        return nullptr;
+    const Slot& slot = slots[handle.index];
+    return slot.generation == handle.generation ? slot.obj : nullptr;
+}
+
+std::size_t Handle_Table::size() const {
+    return live;
+}
@@ -0,0 +1,37 @@
+#ifndef HANDLE_TABLE_H
+#define HANDLE_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "Sim_Obj.h"
+#include "Sim_Types.h"
+
+/**
+ * Handle_Table class
+ * Slots of all simulation objects, a Handle resolves to its object in O(1).
+ * Releasing an object bumps the generation of its slot and frees the slot for reuse,
+ * handles made before the release are then detected as stale and resolve to null.
+ */
+class Handle_Table {
+public:
+    Handle insert(Sim_Obj* obj);                // Give the object a slot, returns its handle.
+    void release(Handle handle);                // Free the slot of a live handle.
+    Sim_Obj* get(Handle handle) const;          // Object of the handle, null if stale.
+    std::size_t size() const;                   // Number of live objects.
+
+    template<typename T>
+    T* resolve(const Handle handle) const {     // Object of the handle as T, null if stale or not a T.
+        return sim_cast<T>(get(handle));
+    }
+
+private:
+    struct Slot {
+        Sim_Obj* obj = nullptr;                 // Object in the slot, null when free.
+        std::uint32_t generation = 1;           // Current generation, never 0.
+    };
+    std::vector<Slot> slots;                    // All slots, index 0 is never used.
+    std::vector<std::uint32_t> free_slots;      // Released slots, reused first.
+    std::size_t live = 0;                       // Slots in use.
+};
+
+#endif //HANDLE_TABLE_H
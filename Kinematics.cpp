@@ -0,0 +1,98 @@
+#include "Kinematics.h"
+
+// Batched position update over plain arrays, restrict parameters let the compiler
+// auto-vectorise the loop (-O3).
+static void advance_positions(double* __restrict px, double* __restrict py,
+                              double* __restrict ox, double* __restrict oy,
+                              const double* __restrict pvx, const double* __restrict pvy,
+                              const double* __restrict pm, const std::size_t n, const double hours) {
+    for (std::size_t i = 0; i < n; ++i) {
+        ox[i] = px[i];
+        oy[i] = py[i];
+        px[i] += pvx[i] * hours * pm[i];
+        py[i] += pvy[i] * hours * pm[i];
+    }
+}
+
+void Kinematics::reserve(const std::size_t count) {
+    const std::size_t size = x.size() + count;
+    x.reserve(size); y.reserve(size);
+    vx.reserve(size); vy.reserve(size);
+    prev_x.reserve(size); prev_y.reserve(size);
+    moving.reserve(size);
+}
+
+std::size_t Kinematics::allocate(const Point& position) {
+    std::size_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot = x.size();
+        x.push_back(0); y.push_back(0);
+        vx.push_back(0); vy.push_back(0);
+        prev_x.push_back(0); prev_y.push_back(0);
+        moving.push_back(0);
+    }
+    x[slot] = prev_x[slot] = position.x;
+    y[slot] = prev_y[slot] = position.y;
+    vx[slot] = vy[slot] = 0;
+    moving[slot] = 0;
+    return slot;
+}
+
+// Released slots keep a zero moving flag, so advance() leaves them untouched.
+void Kinematics::release(const std::size_t slot) {
+    moving[slot] = 0;
+    vx[slot] = vy[slot] = 0;
+    free_slots.push_back(slot);
+}
+
+Point Kinematics::get_position(const std::size_t slot) const {
+    return {x[slot], y[slot]};
+}
+
+Point Kinematics::get_previous(const std::size_t slot) const {
+    return {prev_x[slot], prev_y[slot]};
+}
+
+bool Kinematics::is_moving(const std::size_t slot) const {
+    return moving[slot] != 0;
+}
+
+void Kinematics::set_position(const std::size_t slot, const Point& position) {
+    x[slot] = position.x;
+    y[slot] = position.y;
+}
+
+void Kinematics::set_previous(const std::size_t slot, const Point& position) {
+    prev_x[slot] = position.x;
+    prev_y[slot] = position.y;
+}
+
+void Kinematics::add_position(const std::size_t slot, const double _x, const double _y) {
+    x[slot] += _x;
+    y[slot] += _y;
+}
+
+void Kinematics::set_velocity(const std::size_t slot, const double _vx, const double _vy) {
+    vx[slot] = _vx;
+    vy[slot] = _vy;
+}
+
+void Kinematics::set_moving(const std::size_t slot, const bool _moving) {
+    moving[slot] = _moving ? 1.0 : 0.0;
+}
+
+void Kinematics::advance_slot(const std::size_t slot, const double hours) {
+    prev_x[slot] = x[slot];
+    prev_y[slot] = y[slot];
+    x[slot] += vx[slot] * hours * moving[slot];
+    y[slot] += vy[slot] * hours * moving[slot];
+}
+
+// Slots that are not moving are multiplied by 0.0, keeping the loop branch-free.
+void Kinematics::advance(const double hours) {
+    advance_positions(x.data(), y.data(), prev_x.data(), prev_y.data(),
+                      vx.data(), vy.data(), moving.data(), x.size(), hours);
+}
@@ -0,0 +1,40 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <cstddef>
+#include <vector>
+#include "Geometry.h"
+
+/**
+ * Kinematics class
+ * Structure-of-arrays storage for the position and velocity of every moving object.
+ * Each Track_Base owns one slot, and advance() moves all flagged slots in one batched pass.
+ */
+class Kinematics {
+public:
+    void reserve(std::size_t count);                    // Make room for count more slots.
+    std::size_t allocate(const Point& position);        // Reserve a slot for a new track.
+    void release(std::size_t slot);                     // Return a slot to the free list.
+
+    Point get_position(std::size_t slot) const;         // Get current position.
+    Point get_previous(std::size_t slot) const;         // Get position before the last advance.
+    bool is_moving(std::size_t slot) const;             // Is the slot moved by advance?
+
+    void set_position(std::size_t slot, const Point& position);          // Set position.
+    void set_previous(std::size_t slot, const Point& position);          // Set position before the last advance.
+    void add_position(std::size_t slot, double x, double y);             // Adjust position by offset.
+    void set_velocity(std::size_t slot, double _vx, double _vy);         // Set distance per hour.
+    void set_moving(std::size_t slot, bool moving);                      // Flag slot for the next advance.
+    void advance_slot(std::size_t slot, double hours);                   // Move a single slot.
+
+    void advance(double hours);                         // Move every flagged slot by velocity * hours.
+
+private:
+    std::vector<double> x, y;               // Positions.
+    std::vector<double> vx, vy;             // Velocities (map distance per hour).
+    std::vector<double> prev_x, prev_y;     // Positions before the last advance.
+    std::vector<double> moving;             // 1.0 if the slot moves, 0.0 otherwise.
+    std::vector<std::size_t> free_slots;    // Released slots for reuse.
+};
+
+#endif //KINEMATICS_H
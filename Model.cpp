@@ -1,15 +1,26 @@
 #include "Model.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include "Details.h"
+#include "Scenario_Bundle.h"
+#include "Schedule_Stream.h"
+#include "Shard_Channel.h"
 #include "SimulationException.h"
 
-Model::Model() {
-    sim_time = create_time_for_ticks(); // Create simulation time -> 00:00
+Model::Model() : output(std::cout.rdbuf()) {
+    output.precision(2);
+    output << std::fixed;
     auto default_view = std::make_shared<View>();
     attach(default_view);
-    const auto _default = std::make_shared<Warehouse>("Frankfurt",100000 ,40, 10);  // Default warehouse.
-    _default->mark_main_warehouse();
-    sim_obj_list.emplace_back(std::static_pointer_cast<Sim_Obj>(_default));
+    add_warehouse({"Frankfurt", 100000, 40, 10});  // Default warehouse.
+    warehouses.back()->mark_main_warehouse();
 }
 
 Model& Model::get_instance() {
@@ -19,18 +30,115 @@ Model& Model::get_instance() {
 
 void Model::add_sim_object(const std::shared_ptr<Sim_Obj>& obj) {
     sim_obj_list.push_back(obj);
+    register_object(obj.get());
+    ++registry_version;
+}
+
+// New vehicles are awake, they join the active vehicles last.
+void Model::register_object(Sim_Obj* obj) {
+    handles.insert(obj);
+    if (auto* vehicle = sim_cast<Vehicle>(obj))
+        vehicle->set_order(next_order++);
+    switch (obj->get_kind()) {
+        case Sim_Obj::Truck_Kind:
+            trucks.push_back(static_cast<Truck*>(obj));
+            vehicles.emplace_back(trucks.back());
+            active.push_back(vehicles.back());
+            break;
+        case Sim_Obj::Chopper_Kind:
+            vehicles.emplace_back(static_cast<Chopper*>(obj));
+            active.push_back(vehicles.back());
+            break;
+        case Sim_Obj::Trooper_Kind:
+            troopers.push_back(static_cast<StateTrooper*>(obj));
+            vehicles.emplace_back(troopers.back());
+            active.push_back(vehicles.back());
+            break;
+        case Sim_Obj::Warehouse_Kind:
+            break;
+    }
 }
 
 void Model::create_chopper(const std::string& name, const float x, const float y) {
-    const auto chopper = std::make_shared<Chopper>(name, Point(x, y));
+    const auto chopper = std::make_shared<Chopper>(*this, name, Point(x, y));
     add_sim_object(chopper);
 }
 
 void Model::create_trooper(const std::string& name, const Point& pos, const std::string& warehouse_name) {
-    const auto trooper = std::make_shared<StateTrooper>(name, pos,warehouse_name);
+    const auto trooper = std::make_shared<StateTrooper>(*this, name, pos,warehouse_name);
     add_sim_object(trooper);
 }
 
+// Every row is checked before anything is created, so a bad row leaves the world unchanged.
+// Rows: "<name>, Chopper, <x>, <y>" or "<name>, State_trooper, <warehouse>", '#' starts a comment.
+void Model::create_bulk(const std::string& file_name) {
+    std::ifstream file(file_name);
+    if (!file.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+
+    struct BulkRow {
+        std::string name;
+        Point position;
+        const Warehouse* home;      // Null for a chopper.
+    };
+    std::vector<BulkRow> rows;
+    std::unordered_set<std::string> names;      // Taken names, the registry and the rows so far.
+    names.reserve(sim_obj_list.size());
+    for (const auto& obj : sim_obj_list)
+        names.insert(obj->get_name());
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        const std::string where = "Error: Bulk line " + std::to_string(line_number) + ": ";
+        auto tokens = split_line(line);
+        for (auto& token : tokens)
+            token = trim(token);
+        if (tokens.size() < 3)
+            throw InvalidInputLineException(where + "Expected <name>, <type>, <position or warehouse>");
+        if (!is_valid_sim_name(tokens[0]))
+            throw IllegalNameException(where + "Vehicle name is not valid");
+        if (!names.insert(tokens[0]).second)
+            throw IllegalNameException(where + "Name <" + tokens[0] + "> is already taken");
+
+        if (tokens[1] == ROBBER) {
+            if (tokens.size() != 4 || !is_number(tokens[2]) || !is_number(tokens[3]))
+                throw BadCoordinatesException(where + "Wrong coordinates format");
+            const auto x = parse_number<float>(tokens[2]);
+            const auto y = parse_number<float>(tokens[3]);
+            rows.push_back({tokens[0], Point(x, y), nullptr});
+        } else if (tokens[1] == POLICE) {
+            if (tokens.size() != 3)
+                throw InvalidInputLineException(where + "Expected a home warehouse");
+            const Warehouse* home = find_warehouse_by_name(tokens[2]);
+            if (!home)
+                throw WarehouseNotFoundException(where + "Warehouse <" + tokens[2] + "> not found");
+            rows.push_back({tokens[0], home->get_location(), home});
+        } else {
+            throw InvalidTypeException(where + "Type must be " ROBBER " or " POLICE);
+        }
+    }
+
+    // Build the whole batch aside, then link it into the registry at once.
+    kinematics.reserve(rows.size());
+    std::list<std::shared_ptr<Sim_Obj>> batch;
+    vehicles.reserve(vehicles.size() + rows.size());
+    active.reserve(active.size() + rows.size());
+    for (const auto& row : rows) {
+        if (row.home)
+            batch.push_back(std::make_shared<StateTrooper>(*this, row.name, row.position, row.home->get_name()));
+        else
+            batch.push_back(std::make_shared<Chopper>(*this, row.name, row.position));
+        register_object(batch.back().get());
+    }
+    sim_obj_list.splice(sim_obj_list.end(), batch);
+    ++registry_version;
+}
+
 void Model::set_chopper_course_and_speed(const std::string& name, const double _course, const double _speed) const {
     Chopper* chopper = find_chopper_by_name(name);
     if (!chopper)
@@ -63,7 +171,7 @@ void Model::set_trooper_destination(const std::string& name, const std::string&
 
 void Model::queue_attack(const std::string& attacker, const std::string& target) const {
     Chopper* apache_attack_helicopter = find_chopper_by_name(attacker);
-    const Truck* truck = find_truck_by_name(target);
+    Truck* truck = find_truck_by_name(target);
     if (!apache_attack_helicopter)
         throw VehicleNotFoundException("Error: Attacker not found");
     if (!truck)
@@ -71,7 +179,7 @@ void Model::queue_attack(const std::string& attacker, const std::string& target)
 
     if (truck->get_status() == Vehicle::OffRoad || truck->get_status() == Vehicle::Parked) return;
 
-    apache_attack_helicopter->queue_attack(target,time);
+    apache_attack_helicopter->queue_attack(*truck,time);
 }
 
 void Model::stop_vehicle(const std::string& vehicle_name) const {
@@ -99,12 +207,15 @@ void Model::load_depot_file(const std::string& file_name) {
         int inventory = std::stoi(tokens[3]);
         if (find_warehouse_by_name(tokens[0]) != nullptr) continue;
 
-        auto warehouse = std::make_shared<Warehouse>(tokens[0],inventory ,x, y);
-        sim_obj_list.emplace_back(std::static_pointer_cast<Sim_Obj>(warehouse));
+        scenario.warehouses.push_back({tokens[0], inventory, x, y});
+        add_warehouse(scenario.warehouses.back());
     }
     file.close();
+    get_routes();       // Precompute the routes once all warehouses are known.
 }
 
+// Errors carry the line number. A schedule longer than STREAM_SCHEDULE_STOPS is still validated here
+// in one pass, but only its source is kept, the truck then streams the stops from the file.
 void Model::load_truck_file(const std::string& file_name) {
     std::ifstream file(file_name);
     if (!file.is_open())
@@ -114,6 +225,7 @@ void Model::load_truck_file(const std::string& file_name) {
         throw IllegalNameException("Error: Truck name is not valid");
 
     int accumulator = 0, cases = 0;     // total cases in file, cases each iteration.
+    int line_number = 1;
     std::string line;
     std::list<Details> truck_path;
     std::string source, departure_time;
@@ -121,94 +233,657 @@ void Model::load_truck_file(const std::string& file_name) {
 
     line = trim(line);
     auto tokens = split_line(line);
+    std::string where = "Error: " + file_name + " line 1: ";
 
-    if (find_warehouse_by_name(tokens[0]) == nullptr)
-        throw WarehouseNotFoundException("Error: Warehouse <" + tokens[0] + "> not found");
+    if (tokens.empty() || find_warehouse_by_name(tokens[0]) == nullptr)
+        throw WarehouseNotFoundException(where + "Warehouse <" + (tokens.empty() ? "" : tokens[0]) + "> not found");
 
-    if (!is_valid_time(tokens[1], "00:00"))
-        throw InvalidInputLineException("Error: Wrong file format");
+    if (tokens.size() < 2 || !is_valid_time(tokens[1], "00:00"))
+        throw InvalidInputLineException(where + "Wrong file format");
 
     if (tokens.size() != 2)
-        throw InvalidInputLineException("Error: First line must contain 2 arguments");
+        throw InvalidInputLineException(where + "First line must contain 2 arguments");
 
     source = tokens[0], departure_time = tokens[1];
+    const Details origin(source, departure_time);
+    const std::streamoff stops_offset = file.tellg();
+    bool streaming = false;
 
     while (std::getline(file, line)) {
+        where = "Error: " + file_name + " line " + std::to_string(++line_number) + ": ";
         line = trim(line);
+        if (line.empty()) continue;
         tokens = split_line(line);
 
         if (find_warehouse_by_name(tokens[0]) == nullptr)
-            throw WarehouseNotFoundException("Error: Warehouse <" + tokens[0] + "> not found");
+            throw WarehouseNotFoundException(where + "Warehouse <" + tokens[0] + "> not found");
 
         if (tokens.size() != 4)
-            throw InvalidInputLineException("Error: Every other line must contain 4 arguments");
+            throw InvalidInputLineException(where + "Every other line must contain 4 arguments");
 
         if (!is_valid_truck_line(tokens))
-            throw InvalidInputLineException("Error: Wrong file format");
+            throw InvalidInputLineException(where + "Wrong file format");
 
         accumulator += std::stoi(tokens[2]);
-        truck_path.emplace_back(source,tokens[1], cases ,departure_time);
+        if (!streaming) {
+            truck_path.emplace_back(source,tokens[1], cases ,departure_time);
+            streaming = truck_path.size() > STREAM_SCHEDULE_STOPS;
+        }
         cases = std::stoi(tokens[2]);
 
         source = tokens[0], departure_time = tokens[3];
     }
-    truck_path.emplace_back(source,"00:00",cases,departure_time);
-    std::string truck_name = file_name.substr(0, file_name.find('.'));
+    if (truck_path.empty())
+        throw InvalidInputLineException("Error: " + file_name + " has no stops");
+
+    TruckRecord record;
+    record.name = file_name.substr(0, file_name.find('.'));
+    record.crates = accumulator;
+    if (streaming) {
+        record.path.push_back(origin);
+        record.stream_file = file_name;
+        record.stream_offset = stops_offset;
+    } else {
+        truck_path.emplace_back(source,"00:00",cases,departure_time);
+        record.path = std::move(truck_path);
+    }
+    scenario.trucks.push_back(std::move(record));
+    add_truck(scenario.trucks.back());
+}
+
+// Scenario records were validated when they were read from files, only the objects are created here.
+void Model::load_scenario(const Scenario& _scenario) {
+    for (const auto& record : _scenario.warehouses) {
+        if (find_warehouse_by_name(record.name) != nullptr) continue;
+        scenario.warehouses.push_back(record);
+        add_warehouse(record);
+    }
+    get_routes();
+    for (const auto& record : _scenario.trucks) {
+        scenario.trucks.push_back(record);
+        add_truck(record);
+    }
+    if (_scenario.bundle) {
+        scenario.bundle = _scenario.bundle;
+        add_bundle_trucks(*_scenario.bundle);
+    }
+}
+
+// Warehouses are written with their inventory before any truck loaded, the itineraries as compiled.
+// Streamed trucks keep their schedule file, only the origin is in the bundle.
+void Model::compile_bundle(const std::string& file_name) {
+    Scenario_Bundle::Builder builder;
+    std::vector<int> loaded(warehouses.size(), 0);
+    for (const auto& record : scenario.trucks)
+        loaded[find_warehouse_by_name(record.path.front().get_location_name())->get_index()] += record.crates;
+    for (const Warehouse* warehouse : warehouses) {
+        const Point location = warehouse->get_location();
+        builder.warehouses.push_back({builder.intern(warehouse->get_name()),
+                                      warehouse->get_inventory() + loaded[warehouse->get_index()],
+                                      static_cast<float>(location.x), static_cast<float>(location.y)});
+    }
+
+    for (const auto& record : scenario.trucks) {
+        const Details& origin = record.path.front();
+        Warehouse* source = find_warehouse_by_name(origin.get_location_name());
+        Scenario_Bundle::Truck_Entry entry{};
+        entry.name = builder.intern(record.name);
+        entry.origin = static_cast<std::uint32_t>(source->get_index());
+        entry.crates = record.crates;
+        entry.departure = builder.intern(origin.get_departure_time());
+        entry.stream_file = {BUNDLE_NO_STREAM, 0};
+        entry.leg_begin = static_cast<std::uint32_t>(builder.legs.size());
+        if (!record.stream_file.empty()) {
+            entry.stream_file = builder.intern(record.stream_file);
+            entry.stream_offset = record.stream_offset;
+            entry.stream_stamp = Scenario_Bundle::stamp(record.stream_file);
+        } else {
+            for (const TruckLeg& leg : compile_itinerary(record, source, entry.speed, entry.course))
+                builder.legs.push_back({static_cast<std::uint32_t>(leg.warehouse->get_index()), leg.crates,
+                                        leg.departure_minute, 0, leg.speed, leg.course});
+        }
+        entry.leg_count = static_cast<std::uint32_t>(builder.legs.size()) - entry.leg_begin;
+        builder.trucks.push_back(entry);
+    }
+    builder.write(file_name);
+}
+
+// The bundle replaces the depot and truck files: warehouses become records, so sweeps can build
+// their worlds, and the trucks are created from the mapped itineraries.
+void Model::load_bundle(const std::string& file_name) {
+    auto bundle = std::make_shared<const Scenario_Bundle>(file_name);
+    std::unordered_map<std::string_view, Warehouse*> existing;
+    for (Warehouse* warehouse : warehouses)
+        existing.emplace(warehouse->get_name(), warehouse);
+    for (std::size_t i = 0; i < bundle->warehouse_count(); ++i) {
+        const Scenario_Bundle::Warehouse_Entry& entry = bundle->warehouses()[i];
+        if (existing.count(bundle->name(entry.name))) continue;
+        scenario.warehouses.push_back({std::string(bundle->name(entry.name)), entry.inventory, entry.x, entry.y});
+        add_warehouse(scenario.warehouses.back());
+    }
+    scenario.bundle = bundle;
+    add_bundle_trucks(*bundle);
+}
 
-    auto it = ++truck_path.begin();
-    const Point p0 = find_warehouse_by_name(truck_path.front().get_location_name())->get_location();
-    const Point p1 = find_warehouse_by_name(it->get_location_name())->get_location();
+const Scenario& Model::get_scenario() const {
+    return scenario;
+}
+
+// A sharded world loads every region from the same files, each region keeps the trucks starting in it.
+// Every truck keeps its registry order, so the orders match the ones of a single world.
+void Model::set_truck_filter(std::function<bool(const Point&)> filter) {
+    truck_filter = std::move(filter);
+}
 
-    find_warehouse_by_name(truck_path.front().get_location_name())->update_inventory(accumulator,false);
+bool Model::keeps_truck(const Point& origin) {
+    if (!truck_filter || truck_filter(origin))
+        return true;
+    ++next_order;
+    return false;
+}
+
+void Model::add_warehouse(const WarehouseRecord& record) {
+    auto warehouse = std::make_shared<Warehouse>(record.name, record.inventory, record.x, record.y);
+    warehouse->set_index(warehouses.size());
+    warehouses.push_back(warehouse.get());
+    warehouse_names.emplace(warehouse->get_name(), warehouse.get());
+    add_sim_object(warehouse);
+    routes_dirty = true;
+}
+
+Route_Table& Model::get_routes() {
+    if (routes_dirty) {
+        std::vector<Point> locations;
+        locations.reserve(warehouses.size());
+        for (const auto* warehouse : warehouses)
+            locations.push_back(warehouse->get_location());
+        route_table.build(locations);
+        patrol_tours.clear();
+        routes_dirty = false;
+    }
+    return route_table;
+}
+
+const std::vector<Warehouse*>& Model::get_warehouses() const {
+    return warehouses;
+}
+
+double Model::get_distance(const Warehouse& from, const Warehouse& to) {
+    return get_routes().distance(from.get_index(), to.get_index());
+}
+
+double Model::get_course(const Warehouse& from, const Warehouse& to) {
+    return get_routes().course(from.get_index(), to.get_index());
+}
 
-    double dist = calculate_distance(p0, p1);
-    int mins = time_difference_minutes(truck_path.front().get_departure_time(), truck_path.front().get_arrival_time());
-    double speed = dist / (mins / 60.0);
-    double course = calculate_course_deg(p0, p1);
+// Nearest unvisited warehouse, ties within 1e-6 go to the smaller name. From a warehouse the
+// route table gives the distance, from any other point it is computed.
+Warehouse* Model::find_nearest_unvisited(const Point& from, const Warehouse* from_warehouse,
+                                         const std::vector<bool>& visited) {
+    Warehouse* next = nullptr;
+    double min_dist = std::numeric_limits<double>::max();
+    for (Warehouse* warehouse : warehouses) {
+        if (visited[warehouse->get_index()]) continue;
 
-    truck_path.pop_front();
+        const double dist = from_warehouse ? get_distance(*from_warehouse, *warehouse)
+                                           : calculate_distance(from, warehouse->get_location());
 
-    auto truck = std::make_shared<Truck>(truck_name, speed, course, p0, truck_path);
+        if (dist < min_dist || (std::abs(dist - min_dist) < 1e-6 && warehouse->get_name() < next->get_name())) {
+            min_dist = dist;
+            next = warehouse;
+        }
+    }
+    return next;
+}
+
+// The greedy nearest-unvisited tour from an origin, computed once and shared by all troopers starting there.
+std::shared_ptr<const std::vector<std::size_t>> Model::get_patrol_tour(const std::size_t origin) {
+    get_routes();
+    auto& tour = patrol_tours[origin];
+    if (!tour) {
+        auto stops = std::make_shared<std::vector<std::size_t>>();
+        std::vector<bool> visited(warehouses.size(), false);
+        visited[origin] = true;
+        const Warehouse* current = warehouses[origin];
+        while (Warehouse* next = find_nearest_unvisited(current->get_location(), current, visited)) {
+            stops->push_back(next->get_index());
+            visited[next->get_index()] = true;
+            current = next;
+        }
+        tour = stops;
+    }
+    return tour;
+}
+
+void Model::add_truck(const TruckRecord& record) {
+    const Details& origin = record.path.front();
+    Warehouse* source = find_warehouse_by_name(origin.get_location_name());
+    source->update_inventory(record.crates,false);
+    if (!keeps_truck(source->get_location()))
+        return;
+
+    if (!record.stream_file.empty()) {
+        add_streamed_truck(record.name, source, origin.get_departure_time(), record.crates,
+                           record.stream_file, record.stream_offset);
+        return;
+    }
+
+    double speed, course;
+    std::vector<TruckLeg> legs = compile_itinerary(record, source, speed, course);
+    auto truck = std::make_shared<Truck>(*this, record.name, speed, course, source->get_location(), std::move(legs));
     truck->set_status(Vehicle::MovingTo);
-    sim_obj_list.emplace_back(std::static_pointer_cast<Sim_Obj>(truck));
+    add_sim_object(truck);
 }
 
-StateTrooper* Model::find_state_trooper_by_name(const std::string &trooper_name) const {
+// The path is compiled once: warehouses are resolved, times are turned into minutes, and the speed and
+// course of every leg come from the route table, so the truck never looks at names or time strings again.
+std::vector<TruckLeg> Model::compile_itinerary(const TruckRecord& record, Warehouse* source,
+                                               double& speed, double& course) {
+    // Entry i holds the departure from stop i and the arrival at stop i + 1.
+    std::vector<const Details*> stops;
+    stops.reserve(record.path.size());
+    for (const auto& details : record.path)
+        stops.push_back(&details);
+
+    std::vector<TruckLeg> legs;
+    legs.reserve(stops.size() - 1);
+    for (std::size_t i = 1; i < stops.size(); ++i) {
+        Warehouse* warehouse = find_warehouse_by_name(stops[i]->get_location_name());
+        legs.push_back({warehouse, stops[i]->get_case_quantity(),
+                        time_difference_minutes("00:00", stops[i]->get_departure_time()), 0.0, 0.0});
+    }
+
+    speed = 0.0, course = 0.0;
+    for (std::size_t i = 0; i < legs.size(); ++i) {
+        const Warehouse& from = i == 0 ? *source : *legs[i - 1].warehouse;
+        const double dist = get_distance(from, *legs[i].warehouse);
+        const int mins = time_difference_minutes(stops[i]->get_departure_time(), stops[i]->get_arrival_time());
+        const double leg_speed = dist / (mins / 60.0);
+        const double leg_course = get_course(from, *legs[i].warehouse);
+        if (i == 0) {
+            speed = leg_speed;
+            course = leg_course;
+        } else {
+            legs[i - 1].speed = leg_speed;
+            legs[i - 1].course = leg_course;
+        }
+    }
+    return legs;
+}
+
+// A streamed schedule starts with the origin leg and the first window of stops.
+void Model::add_streamed_truck(const std::string& name, Warehouse* source, const std::string& departure,
+                               const int crates, const std::string& file_name, const std::streamoff offset) {
+    auto stream = std::make_unique<Schedule_Stream>(file_name, offset, 2, source, departure, crates);
+    std::vector<TruckLeg> legs;
+    legs.reserve(SCHEDULE_WINDOW + 1);
+    stream->read(*this, legs, SCHEDULE_WINDOW + 1);
+    const double speed = legs.front().speed, course = legs.front().course;
+    legs.erase(legs.begin());
+    if (stream->exhausted())
+        stream.reset();
+
+    auto truck = std::make_shared<Truck>(*this, name, speed, course, source->get_location(), std::move(legs),
+                                         std::move(stream));
+    truck->set_status(Vehicle::MovingTo);
+    add_sim_object(truck);
+}
+
+// Warehouse indexes of the bundle are mapped by name, the bundle warehouses were added before.
+// In a world loaded from the bundle alone the indexes are the same, and no name needs to be looked up.
+void Model::add_bundle_trucks(const Scenario_Bundle& bundle) {
+    std::vector<Warehouse*> resolved(bundle.warehouse_count());
+    const auto same_index = [&](const std::size_t i) {
+        return i < warehouses.size() && warehouses[i]->get_name() == bundle.name(bundle.warehouses()[i].name);
+    };
+    std::size_t matched = 0;
+    while (matched < resolved.size() && same_index(matched)) {
+        resolved[matched] = warehouses[matched];
+        ++matched;
+    }
+    for (std::size_t i = matched; i < resolved.size(); ++i)
+        resolved[i] = warehouse_names.at(bundle.name(bundle.warehouses()[i].name));
+
+    const auto* entries = bundle.trucks();
+    const auto* bundle_legs = bundle.legs();
+    if (!truck_filter)
+        kinematics.reserve(bundle.truck_count());
+    for (std::size_t i = 0; i < bundle.truck_count(); ++i) {
+        const Scenario_Bundle::Truck_Entry& entry = entries[i];
+        Warehouse* source = resolved[entry.origin];
+        source->update_inventory(entry.crates, false);
+        if (!keeps_truck(source->get_location()))
+            continue;
+        const std::string name(bundle.name(entry.name));
+
+        if (entry.stream_file.offset != BUNDLE_NO_STREAM) {
+            add_streamed_truck(name, source, std::string(bundle.name(entry.departure)), entry.crates,
+                               std::string(bundle.name(entry.stream_file)), entry.stream_offset);
+            continue;
+        }
+        std::vector<TruckLeg> legs;
+        legs.reserve(entry.leg_count);
+        for (std::size_t leg = entry.leg_begin; leg < entry.leg_begin + entry.leg_count; ++leg) {
+            const Scenario_Bundle::Leg_Entry& stop = bundle_legs[leg];
+            legs.push_back({resolved[stop.warehouse], stop.crates, stop.departure_minute, stop.speed, stop.course});
+        }
+        auto truck = std::make_shared<Truck>(*this, name, entry.speed, entry.course, source->get_location(),
+                                             std::move(legs));
+        truck->set_status(Vehicle::MovingTo);
+        add_sim_object(truck);
+    }
+}
+
+StateTrooper* Model::find_state_trooper_by_name(std::string_view trooper_name) const {
     return find_by_name<StateTrooper>(trooper_name);
 }
 
-Chopper* Model::find_chopper_by_name(const std::string &chopper_name) const {
+Chopper* Model::find_chopper_by_name(std::string_view chopper_name) const {
     return find_by_name<Chopper>(chopper_name);
 }
 
-Truck* Model::find_truck_by_name(const std::string& truck_name) const {
+Truck* Model::find_truck_by_name(std::string_view truck_name) const {
     return find_by_name<Truck>(truck_name);
 }
 
-Vehicle* Model::find_vehicle_by_name(const std::string& vehicle_name) const {
+Vehicle* Model::find_vehicle_by_name(std::string_view vehicle_name) const {
     return find_by_name<Vehicle>(vehicle_name);
 }
 
-Warehouse* Model::find_warehouse_by_name(const std::string& warehouse_name) const {
-    return find_by_name<Warehouse>(warehouse_name);
+// Trucks are kept sorted by registry order.
+Truck* Model::find_truck_by_order(const std::size_t order) const {
+    const auto found = std::lower_bound(trucks.begin(), trucks.end(), order,
+                                        [](const Truck* truck, const std::size_t value) { return truck->get_order() < value; });
+    return found != trucks.end() && (*found)->get_order() == order ? *found : nullptr;
+}
+
+// Warehouses are looked up in their own table, not among all objects.
+// Bulk files, schedules and trooper tours look warehouses up by name per row, so this is a hash lookup.
+Warehouse* Model::find_warehouse_by_name(std::string_view warehouse_name) const {
+    const auto found = warehouse_names.find(warehouse_name);
+    return found != warehouse_names.end() ? found->second : nullptr;
 }
 
+// During a step, troopers after the attacking chopper in registry order have not been stepped yet,
+// they are checked where they started the step, as if every vehicle moved one after the other.
+// Ghosts of troopers in other worlds follow the same rule.
 bool Model::is_police_within_range(const Point& target) const {
-    for (const auto& obj : sim_obj_list) {
-        const auto trooper = std::dynamic_pointer_cast<StateTrooper>(obj);
-        if (trooper && calculate_distance(trooper->get_location(), target) <= RANGE) {
+    for (const StateTrooper* trooper : troopers) {
+        const bool pending = stepping_order != NOT_STEPPING && trooper->get_order() > stepping_order;
+        const Point location = pending ? trooper->get_previous_location() : trooper->get_location();
+        if (calculate_distance(location, target) <= RANGE) {
             return true;
         }
     }
+    for (const Trooper_Ghost& ghost : ghosts) {
+        const bool pending = stepping_order != NOT_STEPPING && ghost.order > stepping_order;
+        if (calculate_distance(pending ? ghost.previous : ghost.location, target) <= RANGE)
+            return true;
+    }
     return false;
 }
 
+void Model::set_trooper_ghosts(std::vector<Trooper_Ghost> _ghosts) {
+    ghosts = std::move(_ghosts);
+}
+
+// A trooper is found if either location a police check could use is in range.
+void Model::find_troopers_near(const Point& target, std::vector<Trooper_Ghost>& found) const {
+    for (const StateTrooper* trooper : troopers) {
+        const Point previous = trooper->get_previous_location(), location = trooper->get_location();
+        if (calculate_distance(previous, target) <= RANGE || calculate_distance(location, target) <= RANGE)
+            found.push_back({trooper->get_order(), previous, location});
+    }
+}
+
 int Model::get_time() const {
     return time;
 }
 
-std::time_t Model::get_sim_time() const {
-    return sim_time;
+long Model::get_sim_seconds() const {
+    return sim_seconds;
+}
+
+void Model::set_tick_minutes(const int minutes) {
+    if (minutes <= 0 || minutes > 60 || 60 % minutes != 0)
+        throw InvalidArgumentException("Error: Tick length must divide an hour");
+    tick_seconds = minutes * 60;
+}
+
+int Model::get_tick_minutes() const {
+    return tick_seconds / 60;
+}
+
+int Model::get_minute_of_day() const {
+    return static_cast<int>((sim_seconds / 60) % MINUTES_PER_DAY);
+}
+
+void Model::record_delivery() {
+    ++deliveries;
+}
+
+int Model::get_deliveries() const {
+    return deliveries;
+}
+
+int Model::get_stolen_crates() const {
+    int stolen = 0;
+    for (const auto& vehicle : vehicles) {
+        if (const auto* chopper = std::get_if<Chopper*>(&vehicle))
+            stolen += (*chopper)->get_stolen_crates();
+    }
+    return stolen;
+}
+
+// The recording starts with the current state, a running recording is closed first.
+void Model::start_recording(const std::string& file_name) {
+    telemetry.reset();
+    telemetry = std::make_unique<Telemetry_Writer>(file_name);
+    telemetry->capture(sim_seconds, sim_obj_list, registry_version);
+}
+
+void Model::stop_recording() {
+    telemetry.reset();
+}
+
+void Model::add_proximity_rule(const std::string& first, const std::string& second, const double radius) {
+    const int first_kind = Proximity_Detector::kind_from_name(first);
+    const int second_kind = Proximity_Detector::kind_from_name(second);
+    if (first_kind < 0 || second_kind < 0)
+        throw InvalidTypeException("Error: Proximity types are Truck, " ROBBER " or " POLICE);
+    if (radius <= 0)
+        throw InvalidArgumentException("Error: Proximity radius must be positive");
+    proximity.add_rule(first_kind, second_kind, radius);
+}
+
+void Model::clear_proximity_rules() {
+    proximity.clear();
+}
+
+// The clock and counters, then every object in registry order.
+std::uint64_t Model::checksum() const {
+    return checksum({}, 0);
+}
+
+// The vehicles of other worlds follow the objects of this one, sorted by order, as in a single world
+// whose registry holds the warehouses first. See Shard_Coordinator.
+std::uint64_t Model::checksum(const std::vector<Vehicle_Hash>& others, const int other_deliveries) const {
+    State_Hash hash;
+    hash.add(time);
+    hash.add(static_cast<std::int64_t>(sim_seconds));
+    hash.add(tick_seconds);
+    hash.add(deliveries + other_deliveries);
+    hash.add(static_cast<std::uint64_t>(sim_obj_list.size() + others.size()));
+    for (const auto& obj : sim_obj_list)
+        obj->hash_state(hash);
+    for (const auto& other : others)
+        for (const std::uint64_t word : other.words)
+            hash.add(word);
+    return hash.value();
+}
+
+// Every line is "<time> <seconds> <checksum>", starting with the current state.
+void Model::start_checksum_log(const std::string& file_name) {
+    stop_checksum_log();
+    checksum_log.open(file_name);
+    if (!checksum_log.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+    checksum_log << std::hex << std::setfill('0');
+    checksum_log << std::dec << time << " " << sim_seconds << " " << std::hex << std::setw(16) << checksum() << "\n";
+}
+
+void Model::stop_checksum_log() {
+    if (checksum_log.is_open())
+        checksum_log.close();
+}
+
+// The current state is published at once, a running feed is removed first.
+void Model::start_feed(const std::string& name) {
+    feed.reset();
+    feed = std::make_unique<Position_Feed>(name);
+    feed->publish(time, sim_seconds, sim_obj_list);
+}
+
+void Model::stop_feed() {
+    feed.reset();
+}
+
+// The first snapshot is published before the server answers anything.
+void Model::start_query_server(const std::string& path) {
+    query_server.reset();
+    publish_snapshot();
+    query_server = std::make_unique<Query_Server>(*this, path);
+}
+
+void Model::stop_query_server() {
+    query_server.reset();
+    std::atomic_store(&snapshot, std::shared_ptr<const World_Snapshot>());
+    front.reset();
+}
+
+std::shared_ptr<const World_Snapshot> Model::get_snapshot() const {
+    return std::atomic_load(&snapshot);
+}
+
+// Every publish captures into a new snapshot, readers keep the ones they hold and never see one being written.
+// A snapshot is never reused, use_count() cannot tell when the last reader is done with it.
+void Model::publish_snapshot() {
+    auto next = std::make_shared<World_Snapshot>();
+    next->capture(time, get_minute_of_day(), registry_version, sim_obj_list, front.get());
+    std::atomic_store(&snapshot, std::shared_ptr<const World_Snapshot>(next));
+    front = std::move(next);
+}
+
+// Setting a policy while none was set starts tracking the finished trucks.
+void Model::set_archive_age(const int hours) {
+    if (hours < 0)
+        throw InvalidArgumentException("Error: Archive age must not be negative");
+    if (!is_archiving())
+        start_archiving();
+    archive_age = hours;
+}
+
+void Model::set_archive_limit(const std::size_t count) {
+    if (!is_archiving())
+        start_archiving();
+    archive_limit = count;
+}
+
+void Model::stop_archiving() {
+    archive_age = -1;
+    archive_limit = ARCHIVE_NO_LIMIT;
+    finished.clear();
+    finished_count = 0;
+    for (Truck* truck : trucks)
+        truck->set_finished_mark(0);
+}
+
+void Model::spill_archive(const std::string& file_name) {
+    archive.spill(file_name);
+}
+
+bool Model::is_archiving() const {
+    return archive_age >= 0 || archive_limit != ARCHIVE_NO_LIMIT;
+}
+
+// Finished trucks asleep already are counted now, in registry order.
+void Model::start_archiving() {
+    finished.clear();
+    finished_count = 0;
+    for (Truck* truck : trucks)
+        if (!truck->is_awake() && truck->is_finished())
+            queue_finished(*truck);
+}
+
+// The mark tells the entry of the current sleep apart from the ones left by earlier sleeps of the truck.
+void Model::queue_finished(Truck& truck) {
+    truck.set_finished_mark(++last_finished_mark);
+    finished.push_back({truck.get_handle(), sim_seconds, last_finished_mark});
+    ++finished_count;
+}
+
+// Runs once an hour. An entry is stale once its truck was woken (the mark was cleared) or went to sleep
+// again (the mark changed), stale entries are dropped and only the others count against the limit.
+// The retired trucks leave every registry in one pass.
+void Model::retire_finished() {
+    if (finished.empty())
+        return;
+    std::unordered_set<const Sim_Obj*> retired;
+    const auto current = [this](const Finished& entry) -> Truck* {
+        Truck* truck = resolve<Truck>(entry.truck);
+        return truck && truck->get_finished_mark() == entry.mark ? truck : nullptr;
+    };
+    while (!finished.empty()) {
+        const Finished& oldest = finished.front();
+        if (Truck* truck = current(oldest)) {
+            const bool aged = archive_age >= 0 && sim_seconds - oldest.seconds >= archive_age * SECONDS_PER_HOUR;
+            if (!aged && finished_count <= archive_limit)
+                break;
+            archive.add(*truck, time);
+            handles.release(truck->get_handle());
+            retired.insert(truck);
+            --finished_count;
+        }
+        finished.pop_front();
+    }
+    // Trucks that keep waking up leave stale entries behind the oldest one, they are dropped once they
+    // outnumber the current ones.
+    if (finished.size() > 2 * finished_count)
+        finished.erase(std::remove_if(finished.begin(), finished.end(),
+                                      [&](const Finished& entry) { return current(entry) == nullptr; }),
+                       finished.end());
+    if (retired.empty())
+        return;
+
+    proximity.retire(time, retired, output);
+    const auto is_retired = [&](const Sim_Obj* obj) { return retired.count(obj) != 0; };
+    trucks.erase(std::remove_if(trucks.begin(), trucks.end(), is_retired), trucks.end());
+    vehicles.erase(std::remove_if(vehicles.begin(), vehicles.end(), [&](const Vehicle_Ref& vehicle) {
+        return std::visit([&](const Sim_Obj* target) { return is_retired(target); }, vehicle);
+    }), vehicles.end());
+    sim_obj_list.remove_if([&](const std::shared_ptr<Sim_Obj>& obj) { return is_retired(obj.get()); });
+    ++registry_version;
+}
+
+std::size_t Model::get_registry_version() const {
+    return registry_version;
+}
+
+Kinematics& Model::get_kinematics() {
+    return kinematics;
+}
+
+// The old sink is flushed and closed first, text a ring kept is written into the new one.
+void Model::set_sink(std::unique_ptr<Output_Sink> _sink) {
+    output.flush();
+    const std::string kept = sink ? sink->retained() : std::string();
+    output.rdbuf(_sink ? _sink.get() : std::cout.rdbuf());
+    sink = std::move(_sink);
+    output << kept << std::flush;
+}
+
+std::ostream& Model::get_output() const {
+    return output;
 }
 
 std::list<std::shared_ptr<View>> & Model::get_view_list() {
@@ -219,10 +894,56 @@ std::list<std::shared_ptr<Sim_Obj>> & Model::get_sim_list() {
     return sim_obj_list;
 }
 
+const std::list<std::shared_ptr<Sim_Obj>> & Model::get_sim_list() const {
+    return sim_obj_list;
+}
+
+// Large worlds are split into ranges, every thread formats its range into its own text and the texts
+// are written in registry order, so the output is the same as the one of a single thread.
 void Model::broadcast_status() const {
-    for (const auto& obj : sim_obj_list) {
-        obj->broadcast_current_state();
+    unsigned threads = STATUS_THREADS > 0 ? STATUS_THREADS : std::max(1u, std::thread::hardware_concurrency());
+    if (sim_obj_list.size() < PARALLEL_STATUS_MIN)
+        threads = 1;
+    if (threads == 1) {
+        Status_Text text;
+        for (const auto& obj : sim_obj_list) {
+            obj->broadcast_current_state(text);
+            if (text.size() >= OUTPUT_BUFFER_SIZE) {
+                output << text.str();
+                text.clear();
+            }
+        }
+        output << text.str() << std::flush;
+        return;
+    }
+
+    std::vector<const Sim_Obj*> objects;
+    objects.reserve(sim_obj_list.size());
+    for (const auto& obj : sim_obj_list)
+        objects.push_back(obj.get());
+    std::vector<Status_Text> texts(threads);
+    const auto format = [&](const std::size_t begin, const std::size_t end, Status_Text& text) {
+        text.clear();
+        for (std::size_t i = begin; i < end; ++i)
+            objects[i]->broadcast_current_state(text);
+    };
+    for (std::size_t round = 0; round < objects.size(); round += static_cast<std::size_t>(threads) * STATUS_CHUNK) {
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            const std::size_t begin = std::min(objects.size(), round + t * STATUS_CHUNK);
+            workers.emplace_back(format, begin, std::min(objects.size(), begin + STATUS_CHUNK), std::ref(texts[t]));
+        }
+        format(round, std::min(objects.size(), round + STATUS_CHUNK), texts[0]);
+        for (auto& worker : workers)
+            worker.join();
+        for (const auto& text : texts)
+            output << text.str();
     }
+    output << std::flush;
+}
+
+void Model::broadcast_archive() {
+    archive.print(output);
 }
 
 void Model::attach(std::shared_ptr<View>& v) {
@@ -237,47 +958,239 @@ void Model::detach(const std::shared_ptr<View>& v) {
 
 void Model::notify_views() const {
     for (const auto& v : view_list) {
-        v->show();
+        v->show(*this);
     }
 }
 
+// Advances the reported time by one hour, running the hour as equal sub-steps of tick_seconds.
 void Model::update(){
+    begin_hour();
+    const int steps = SECONDS_PER_HOUR / tick_seconds;
+    for (int step = 0; step < steps; ++step)
+        sub_step();
+    if (query_server)
+        publish_snapshot();
+}
+
+void Model::begin_hour() {
     ++time;
+    retire_finished();
+}
+
+// Every sub-step moves all vehicles in one batched Kinematics pass, then resolves arrivals and attacks.
+void Model::sub_step(std::vector<Chopper*>* held) {
+    begin_vehicle_steps();
+    kinematics.advance(static_cast<double>(tick_seconds) / SECONDS_PER_HOUR);
     update_trucks();
-    update_choppers_and_troopers();
-    sim_time += static_cast<time_t>(3600);
+    update_choppers_and_troopers(held);
+    sim_seconds += tick_seconds;
+    if (telemetry)
+        telemetry->capture(sim_seconds, sim_obj_list, registry_version);
+    proximity.detect(time, sim_obj_list, registry_version, output);
+    if (feed)
+        feed->publish(time, sim_seconds, sim_obj_list);
+    if (checksum_log.is_open())
+        checksum_log << std::dec << time << " " << sim_seconds << " " << std::hex << std::setw(16) << checksum() << "\n";
+}
+
+// The world holds the targets and the troopers of the step as ghosts, see Shard_Coordinator.
+void Model::step_held(Chopper& chopper) {
+    stepping_order = chopper.get_order();
+    chopper.end_step();
+    stepping_order = NOT_STEPPING;
+}
+
+// Calls go through the final vehicle types, the compiler resolves them statically and can inline them.
+// A vehicle that stays and is dormant leaves the active vehicles, its end_step would do nothing either.
+void Model::begin_vehicle_steps() {
+    if (!woken.empty())
+        merge_woken();
+    std::size_t kept = 0;
+    const bool archiving = is_archiving();
+    for (const auto& vehicle : active) {
+        const bool stays_active = std::visit([&](auto* target) {
+            if (target->begin_step() || !target->is_dormant())
+                return true;
+            target->set_awake(false);
+            if constexpr (std::is_same_v<decltype(target), Truck*>)
+                if (archiving && target->is_finished()) queue_finished(*target);
+            return false;
+        }, vehicle);
+        if (stays_active)
+            active[kept++] = vehicle;
+    }
+    active.resize(kept);
 }
 
 void Model::update_trucks() const {
-    for (const auto& sim_obj : sim_obj_list) {
-        if (const auto truck = std::dynamic_pointer_cast<Truck>(sim_obj)) {
-            if (truck->get_status() == Vehicle::Stopped || truck->get_status() == Vehicle::OffRoad)
-                continue;
-            sim_obj->update();
+    for (const auto& vehicle : active) {
+        Truck* const* truck = std::get_if<Truck*>(&vehicle);
+        if (!truck || (*truck)->get_status() == Vehicle::Stopped || (*truck)->get_status() == Vehicle::OffRoad)
+            continue;
+        (*truck)->end_step();
+    }
+}
+
+// Choppers and troopers keep their registry order, an attack depends on where the troopers are.
+// The order being stepped is kept, so an attack sees the troopers after it at their start of the step.
+// A chopper due to attack is held back instead when held is given, its targets may be in another world.
+void Model::update_choppers_and_troopers(std::vector<Chopper*>* held) {
+    for (const auto& vehicle : active) {
+        std::visit([&](auto* target) {
+            if constexpr (!std::is_same_v<decltype(target), Truck*>) {
+                if constexpr (std::is_same_v<decltype(target), Chopper*>)
+                    if (held && target->has_due_attack(time)) {
+                        held->push_back(target);
+                        return;
+                    }
+                stepping_order = target->get_order();
+                target->end_step();
+            }
+        }, vehicle);
+    }
+    stepping_order = NOT_STEPPING;
+}
+
+// Woken during a step or by a command, the vehicle is stepped again from the next step on.
+// A woken truck is not finished anymore, its entry goes stale.
+void Model::wake(Vehicle& vehicle) {
+    switch (vehicle.get_kind()) {
+        case Sim_Obj::Truck_Kind: {
+            auto* truck = static_cast<Truck*>(&vehicle);
+            if (truck->get_finished_mark() != 0) {
+                truck->set_finished_mark(0);
+                --finished_count;
+            }
+            woken.emplace_back(truck);
+            break;
         }
+        case Sim_Obj::Chopper_Kind: woken.emplace_back(static_cast<Chopper*>(&vehicle)); break;
+        case Sim_Obj::Trooper_Kind: woken.emplace_back(static_cast<StateTrooper*>(&vehicle)); break;
+        case Sim_Obj::Warehouse_Kind: break;
+    }
+}
+
+// Both lists are sorted by registry order, so one merge keeps the step order of the full registry.
+void Model::merge_woken() {
+    const auto order_of = [](const Vehicle_Ref& vehicle) {
+        return std::visit([](const auto* target) { return target->get_order(); }, vehicle);
+    };
+    const auto by_order = [&](const Vehicle_Ref& a, const Vehicle_Ref& b) { return order_of(a) < order_of(b); };
+    std::sort(woken.begin(), woken.end(), by_order);
+    const std::size_t middle = active.size();
+    active.insert(active.end(), woken.begin(), woken.end());
+    std::inplace_merge(active.begin(), active.begin() + static_cast<std::ptrdiff_t>(middle), active.end(), by_order);
+    woken.clear();
+}
+
+std::size_t Model::get_active_count() const {
+    return active.size() + woken.size();
+}
+
+void Model::keep_reports(std::vector<Vehicle_Report>* _reports) {
+    reports = _reports;
+}
+
+void Model::report(const std::size_t order, const std::string& text) {
+    if (reports)
+        reports->push_back({order, text});
+    else
+        output << text << std::endl;
+}
+
+// Every vehicle is its type, then its own state.
+void Model::pack_vehicles(const std::vector<Vehicle*>& moved, Shard_Message& message) {
+    message.put(static_cast<std::uint64_t>(moved.size()));
+    for (const Vehicle* vehicle : moved) {
+        message.put(static_cast<std::uint8_t>(vehicle->get_kind()));
+        vehicle->pack(message);
     }
 }
 
-void Model::update_choppers_and_troopers() const {
-    for (const auto& sim_obj : sim_obj_list) {
-        if (std::dynamic_pointer_cast<Chopper>(sim_obj)) {
-            const auto chopper = std::dynamic_pointer_cast<Chopper>(sim_obj);
-            chopper->update();
-        }else if (std::dynamic_pointer_cast<StateTrooper>(sim_obj)){
-            const auto trooper = std::dynamic_pointer_cast<StateTrooper>(sim_obj);
-            trooper->update();
+// The vehicles keep their registry order, they are merged into every registry by it, the objects
+// after the warehouses. Awake ones are woken, so they are stepped from the next step on.
+void Model::adopt(Shard_Message& message) {
+    std::vector<std::shared_ptr<Vehicle>> batch(message.get<std::uint64_t>());
+    for (auto& vehicle : batch) {
+        switch (message.get<std::uint8_t>()) {
+            case Sim_Obj::Truck_Kind: vehicle = std::make_shared<Truck>(*this, message); break;
+            case Sim_Obj::Chopper_Kind: vehicle = std::make_shared<Chopper>(*this, message); break;
+            case Sim_Obj::Trooper_Kind: vehicle = std::make_shared<StateTrooper>(*this, message); break;
+            default: throw FileException("Error: Region message holds an unknown vehicle type");
         }
     }
+    if (batch.empty())
+        return;
+    std::sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) { return a->get_order() < b->get_order(); });
+
+    const std::size_t vehicles_before = vehicles.size(), trucks_before = trucks.size();
+    const std::size_t troopers_before = troopers.size();
+    std::list<std::shared_ptr<Sim_Obj>> objects;
+    for (const auto& vehicle : batch) {
+        handles.insert(vehicle.get());
+        Vehicle_Ref ref = static_cast<Truck*>(nullptr);
+        switch (vehicle->get_kind()) {
+            case Sim_Obj::Truck_Kind: trucks.push_back(static_cast<Truck*>(vehicle.get())); ref = trucks.back(); break;
+            case Sim_Obj::Chopper_Kind: ref = static_cast<Chopper*>(vehicle.get()); break;
+            case Sim_Obj::Trooper_Kind:
+                troopers.push_back(static_cast<StateTrooper*>(vehicle.get()));
+                ref = troopers.back();
+                break;
+            case Sim_Obj::Warehouse_Kind: break;
+        }
+        vehicles.push_back(ref);
+        if (vehicle->is_awake())
+            woken.push_back(ref);
+        objects.push_back(vehicle);
+    }
+    const auto by_order = [](const Vehicle* a, const Vehicle* b) { return a->get_order() < b->get_order(); };
+    const auto ref_by_order = [&](const Vehicle_Ref& a, const Vehicle_Ref& b) {
+        return std::visit([&](const Vehicle* x, const Vehicle* y) { return by_order(x, y); }, a, b);
+    };
+    const auto middle = [](auto& registry, const std::size_t before) {
+        return registry.begin() + static_cast<std::ptrdiff_t>(before);
+    };
+    std::inplace_merge(vehicles.begin(), middle(vehicles, vehicles_before), vehicles.end(), ref_by_order);
+    std::inplace_merge(trucks.begin(), middle(trucks, trucks_before), trucks.end(), by_order);
+    std::inplace_merge(troopers.begin(), middle(troopers, troopers_before), troopers.end(), by_order);
+
+    const auto key = [](const std::shared_ptr<Sim_Obj>& obj) {
+        const auto* vehicle = sim_cast<Vehicle>(obj.get());
+        return vehicle ? vehicle->get_order() + 1 : 0;
+    };
+    sim_obj_list.merge(objects, [&](const auto& a, const auto& b) { return key(a) < key(b); });
+    ++registry_version;
+}
+
+// The vehicles leave every registry in one pass, the last reference to them is dropped with sim_obj_list.
+void Model::release(const std::vector<Vehicle*>& moved) {
+    if (moved.empty())
+        return;
+    std::unordered_set<const Sim_Obj*> gone(moved.begin(), moved.end());
+    for (const Vehicle* vehicle : moved)
+        handles.release(vehicle->get_handle());
+    const auto is_gone = [&](const Sim_Obj* obj) { return gone.count(obj) != 0; };
+    const auto ref_is_gone = [&](const Vehicle_Ref& vehicle) {
+        return std::visit([&](const Sim_Obj* target) { return is_gone(target); }, vehicle);
+    };
+    trucks.erase(std::remove_if(trucks.begin(), trucks.end(), is_gone), trucks.end());
+    troopers.erase(std::remove_if(troopers.begin(), troopers.end(), is_gone), troopers.end());
+    vehicles.erase(std::remove_if(vehicles.begin(), vehicles.end(), ref_is_gone), vehicles.end());
+    active.erase(std::remove_if(active.begin(), active.end(), ref_is_gone), active.end());
+    woken.erase(std::remove_if(woken.begin(), woken.end(), ref_is_gone), woken.end());
+    sim_obj_list.remove_if([&](const std::shared_ptr<Sim_Obj>& obj) { return is_gone(obj.get()); });
+    ++registry_version;
 }
 
 std::string Model::get_warehouse_name_from_point(const Point& point) const {
-    for (const auto& obj_ptr : sim_obj_list) {
-        if (std::dynamic_pointer_cast<Warehouse>(obj_ptr)) {
-            const auto warehouse = std::dynamic_pointer_cast<Warehouse>(obj_ptr);
-            Point warehouse_point = warehouse->get_location();
-            if (warehouse_point == point)
-                return warehouse->get_name();
-        }
+    const Warehouse* warehouse = find_warehouse_at(point);
+    return warehouse ? warehouse->get_name() : "";
+}
+
+Warehouse* Model::find_warehouse_at(const Point& point) const {
+    for (Warehouse* warehouse : warehouses) {
+        if (warehouse->get_location() == point)
+            return warehouse;
     }
-    return "";
+    return nullptr;
 }
\ No newline at end of file
@@ -1,35 +1,94 @@
 /**
- * Model class (Singleton)
+ * Model class
  * Manages all simulation objects (vehicles, choppers, troopers, warehouses) and simulation state.
  * Provides functions to create, find, and control simulation objects, manage views, and update simulation time and state.
+ * Every vehicle is bound to the Model that created it, so several independent worlds can run side by side,
+ * get_instance() is the default world used by the interactive simulation.
+ * Next to the object list the Model indexes vehicles by their final type, so the step loop runs without RTTI.
+ * Objects refer to each other by Handle, resolved through the Model in O(1).
+ * Only active vehicles are stepped: a dormant vehicle (stopped, robbed, at the end of its path) is put to sleep
+ * and wakes when its state changes, so the cost of a step follows the vehicles that can still change.
+ * With an archive policy, finished trucks are retired into a Truck_Archive and removed from the live storage.
  */
 #ifndef MODEL_H
 #define MODEL_H
 
+#include <deque>
+#include <functional>
+#include <limits>
 #include <list>
 #include <memory>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "Chopper.h"
 #include "View.h"
 #include "Warehouse.h"
+#include "Kinematics.h"
+#include "Handle_Table.h"
+#include "Output_Sink.h"
+#include "Scenario.h"
+#include "Sim_Types.h"
+#include "Position_Feed.h"
+#include "Proximity_Detector.h"
+#include "Query_Server.h"
+#include "Route_Table.h"
+#include "Telemetry_Writer.h"
+#include "Truck_Archive.h"
 #include "Utils.h"
+#include "World_Snapshot.h"
 #include <fstream>
 #include "StateTrooper.h"
 #include "Truck.h"
 
 #define RANGE 10.0
+#define SECONDS_PER_HOUR 3600
+#define MINUTES_PER_DAY 1440
+#ifndef STATUS_THREADS
+#define STATUS_THREADS 0                // Threads formatting a large status, 0 uses every core (-DSTATUS_THREADS=...).
+#endif
+#define PARALLEL_STATUS_MIN 16384       // Smaller worlds are formatted on the simulation thread.
+#define STATUS_CHUNK 65536              // Objects per thread and round, bounds the text held at once.
+#define NOT_STEPPING std::numeric_limits<std::size_t>::max()        // No chopper / trooper step in progress.
+#define ARCHIVE_NO_LIMIT std::numeric_limits<std::size_t>::max()    // Finished trucks kept live without a count policy.
 
 class Chopper;
+class Shard_Message;
 class Vehicle;
 class Truck;
 class Warehouse;
 
+// A trooper of another world (region), checked for police range as if it was in this one.
+struct Trooper_Ghost {
+    std::size_t order;      // Registry order of the trooper.
+    Point previous;         // Location before the last movement.
+    Point location;         // Current location.
+};
+
+// Hash input of a vehicle of another world (region), mixed into the checksum at its registry order.
+struct Vehicle_Hash {
+    std::size_t order;                  // Registry order of the vehicle.
+    std::vector<std::uint64_t> words;   // Words its hash_state fed.
+};
+
+// Error a truck met during a step, kept to be printed in registry order with the ones of other worlds.
+struct Vehicle_Report {
+    std::size_t order;      // Registry order of the truck.
+    std::string text;       // Error text.
+};
+
 class Model {
 public:
-    static Model& get_instance();              // Get singleton instance.
+    Model();                                   // Constructor, empty world with the default warehouse.
+    Model(const Model&) = delete;              // Delete copy constructor.
+    Model& operator=(const Model&) = delete;   // Delete assignment operator.
+    static Model& get_instance();              // Get the default world.
 
     void add_sim_object(const std::shared_ptr<Sim_Obj>& obj); // Add a simulation object.
     void create_chopper(const std::string& name, float x, float y); // Create chopper.
     void create_trooper(const std::string& name, const Point& pos, const std::string& warehouse_name); // Create trooper.
+    void create_bulk(const std::string& file_name);                   // Create choppers and troopers of a CSV file.
     void set_chopper_course_and_speed(const std::string& name, double _course, double _speed) const;   // Set chopper course and speed.
     void set_trooper_course(const std::string& name, double _course) const;                            // Set trooper course.
     void set_trooper_destination(const std::string& name, const std::string& _destination) const;      // Set trooper destination.
@@ -39,51 +98,168 @@ public:
 
     void load_depot_file(const std::string& file_name);       // Load depot file.
     void load_truck_file(const std::string& file_name);       // Load a truck file.
+    void load_scenario(const Scenario& scenario);             // Load an already validated scenario.
+    void compile_bundle(const std::string& file_name);        // Write the scenario loaded from files as a bundle.
+    void load_bundle(const std::string& file_name);           // Load a compiled bundle, no text parsing.
+    const Scenario& get_scenario() const;                     // Everything loaded from files so far.
+    void set_truck_filter(std::function<bool(const Point&)> filter);  // Create only trucks whose origin passes, null all.
 
-    StateTrooper* find_state_trooper_by_name(const std::string& trooper_name) const; // Find the trooper by name.
-    Chopper* find_chopper_by_name(const std::string& chopper_name) const;            // Find chopper by name.
-    Truck* find_truck_by_name(const std::string& truck_name) const;                  // Find truck by name.
-    Vehicle* find_vehicle_by_name(const std::string& vehicle_name) const;            // Find vehicle by name.
-    Warehouse* find_warehouse_by_name(const std::string& warehouse_name) const;      // Find warehouse by name.
+    StateTrooper* find_state_trooper_by_name(std::string_view trooper_name) const; // Find the trooper by name.
+    Chopper* find_chopper_by_name(std::string_view chopper_name) const;            // Find chopper by name.
+    Truck* find_truck_by_name(std::string_view truck_name) const;                  // Find truck by name.
+    Vehicle* find_vehicle_by_name(std::string_view vehicle_name) const;            // Find vehicle by name.
+    Truck* find_truck_by_order(std::size_t order) const;                          // Find truck by registry order.
+    Warehouse* find_warehouse_by_name(std::string_view warehouse_name) const;      // Find warehouse by name.
     std::string get_warehouse_name_from_point(const Point& point) const;             // Get warehouse name from point.
+    Warehouse* find_warehouse_at(const Point& point) const;                          // Find warehouse at point.
+    const std::vector<Warehouse*>& get_warehouses() const;                           // Warehouses by index.
+
+    double get_distance(const Warehouse& from, const Warehouse& to);  // Distance between warehouses (route table).
+    double get_course(const Warehouse& from, const Warehouse& to);    // Course between warehouses (route table).
+    Warehouse* find_nearest_unvisited(const Point& from, const Warehouse* from_warehouse,
+                                      const std::vector<bool>& visited);  // Closest warehouse not yet visited.
+    std::shared_ptr<const std::vector<std::size_t>> get_patrol_tour(std::size_t origin);  // Shared greedy tour.
 
     bool is_police_within_range(const Point& target) const;  // Check if troopers are within RANGE km of target.
+    void set_trooper_ghosts(std::vector<Trooper_Ghost> ghosts);   // Troopers of other worlds for police range checks.
+    void find_troopers_near(const Point& target, std::vector<Trooper_Ghost>& found) const;  // Troopers that may be in range.
     int get_time() const;                                    // Get simulation time.
+    long get_sim_seconds() const;                            // Get simulation clock, seconds since the first 00:00.
+    void set_tick_minutes(int minutes);                      // Set the sub-step length, must divide an hour.
+    int get_tick_minutes() const;                            // Get the sub-step length in minutes.
 
-    std::time_t get_sim_time() const;                        // Get system simulation time.
+    int get_minute_of_day() const;                           // Get simulation clock, minutes since 00:00.
+    void record_delivery();                                  // Count a truck arrival at a warehouse.
+    int get_deliveries() const;                              // Get completed deliveries.
+    int get_stolen_crates() const;                           // Get crates stolen by all choppers.
+    Kinematics& get_kinematics();                            // Get position / velocity storage.
+    void start_recording(const std::string& file_name);      // Record every step into a telemetry file.
+    void stop_recording();                                   // Flush and close the telemetry file.
+    void add_proximity_rule(const std::string& first, const std::string& second, double radius); // Watch a type pair.
+    void clear_proximity_rules();                            // Stop proximity events.
+    std::uint64_t checksum() const;                          // Hash of the whole world state, one pass.
+    std::uint64_t checksum(const std::vector<Vehicle_Hash>& others, int other_deliveries) const;  // With other worlds.
+    void start_checksum_log(const std::string& file_name);   // Log the checksum after every step.
+    void stop_checksum_log();                                // Close the checksum log.
+    void start_feed(const std::string& name);                // Publish positions into shared memory every step.
+    void stop_feed();                                        // Remove the shared memory segment.
+    void start_query_server(const std::string& path);        // Publish snapshots and answer queries on a socket.
+    void stop_query_server();                                // Close the socket, stop publishing.
+    std::shared_ptr<const World_Snapshot> get_snapshot() const;  // Latest published snapshot, any thread.
+    void set_archive_age(int hours);                         // Archive trucks finished for at least hours.
+    void set_archive_limit(std::size_t count);               // Keep at most count finished trucks live.
+    void stop_archiving();                                   // Keep finished trucks live, archived ones stay archived.
+    void spill_archive(const std::string& file_name);        // Write archived trucks into a file instead of memory.
+    std::size_t get_registry_version() const;                // Changes whenever objects are added or removed.
+    void set_sink(std::unique_ptr<Output_Sink> sink);        // Route all output into the sink, null is stdout.
+    std::ostream& get_output() const;                        // Stream all simulation output is printed to.
     std::list<std::shared_ptr<View>>& get_view_list();       // Get a list of views.
     std::list<std::shared_ptr<Sim_Obj>>& get_sim_list();     // Get a list of simulation objects.
+    const std::list<std::shared_ptr<Sim_Obj>>& get_sim_list() const;
 
-    void broadcast_status() const;                           // Broadcast status to views.
+    void broadcast_status() const;                           // Broadcast status to views, large worlds in parallel.
+    void broadcast_archive();                                // Print the archived trucks.
     void attach(std::shared_ptr<View>& v);                   // Attach view.
     void detach(const std::shared_ptr<View>& v);             // Detach view.
     void notify_views() const;                               // Notify views.
 
-    void update();                                           // Update simulation.
-    void update_trucks() const;                              // Update trucks.
-    void update_choppers_and_troopers() const;               // Update choppers and troopers.
+    void update();                                           // Update simulation by one hour of sub-steps.
+    void begin_hour();                                       // Advance the reported time, retire finished trucks.
+    void sub_step(std::vector<Chopper*>* held = nullptr);    // One sub-step, choppers due to attack are held if given.
+    void step_held(Chopper& chopper);                        // Step a held chopper in its place of the step order.
+    void begin_vehicle_steps();                              // Let every active vehicle decide if it moves.
+    void update_trucks() const;                              // Update active trucks after movement.
+    void update_choppers_and_troopers(std::vector<Chopper*>* held = nullptr);  // Update choppers and troopers after movement.
+    void wake(Vehicle& vehicle);                             // Return a sleeping vehicle to the active vehicles.
+    std::size_t get_active_count() const;                    // Vehicles stepped, woken ones included.
+    void keep_reports(std::vector<Vehicle_Report>* reports); // Keep truck errors instead of printing them, null prints.
+    void report(std::size_t order, const std::string& text); // Print a truck error, or keep it.
+
+    static void pack_vehicles(const std::vector<Vehicle*>& moved, Shard_Message& message);  // Pack for another world.
+    void adopt(Shard_Message& message);                      // Add the vehicles packed by another world.
+    void release(const std::vector<Vehicle*>& moved);        // Remove vehicles that moved into another world.
+
+    template<typename T>
+    T* resolve(const Handle handle) const {                   // Object of a handle in O(1), null if stale.
+        return handles.resolve<T>(handle);
+    }
 
     template<typename T>
-    T* find_by_name(const std::string& obj_name) const {     // Find any object by name via type provided.
+    T* find_by_name(const std::string_view obj_name) const {  // Find any object by name via type provided.
         for (const auto& obj_ptr : sim_obj_list) {
-            auto target = std::dynamic_pointer_cast<T>(obj_ptr);
-            if (target && obj_ptr->get_name() == obj_name) {
-                return target.get();
-            }
+            if (obj_ptr->get_name() != obj_name) continue;
+            if (auto* target = sim_cast<T>(obj_ptr.get()))
+                return target;
         }
         return nullptr;
     }
 
 private:
-    Model();                                 // Private constructor.
-    Model(const Model&) = delete;            // Delete copy constructor.
-    Model& operator=(const Model&) = delete; // Delete assignment operator.
+    void add_warehouse(const WarehouseRecord& record);       // Create a warehouse from a record.
+    void add_truck(const TruckRecord& record);               // Create a truck from a record.
+    std::vector<TruckLeg> compile_itinerary(const TruckRecord& record, Warehouse* source,
+                                            double& speed, double& course);   // Legs of a record, first leg speed / course.
+    void add_streamed_truck(const std::string& name, Warehouse* source, const std::string& departure, int crates,
+                            const std::string& file_name, std::streamoff offset);  // Truck reading its stops from a file.
+    void add_bundle_trucks(const Scenario_Bundle& bundle);   // Create the trucks of a bundle.
+    bool keeps_truck(const Point& origin);                   // Does the truck filter keep a truck, skips its order if not.
+    void register_object(Sim_Obj* obj);                      // Index a new object by its type.
+    Route_Table& get_routes();                               // Route table, rebuilt if warehouses changed.
+    void publish_snapshot();                                 // Capture the world and swap it in for readers.
+    void merge_woken();                                      // Merge woken vehicles into the active ones by order.
+    bool is_archiving() const;                               // Is an archive policy set?
+    void start_archiving();                                  // Track the trucks already finished.
+    void queue_finished(Truck& truck);                       // Count a truck gone to sleep as finished.
+    void retire_finished();                                  // Archive trucks past the policy, compact the registry.
 
+    Kinematics kinematics;                            // Positions and velocities of all vehicles, outlives them.
     std::list<std::shared_ptr<Sim_Obj>> sim_obj_list; // List of simulation objects.
     std::list<std::shared_ptr<View>> view_list;       // List of attached views.
+    Handle_Table handles;                             // Handles of all objects, for references between them.
+    std::vector<Vehicle_Ref> vehicles;                // Vehicles in registry order, by final type.
+    std::vector<Truck*> trucks;                       // Trucks in registry order.
+    std::vector<StateTrooper*> troopers;              // Troopers in registry order.
+    std::vector<Vehicle_Ref> active;                  // Vehicles stepped, in registry order.
+    std::vector<Vehicle_Ref> woken;                   // Woken since the last step, merged into active before it.
+    std::size_t next_order = 0;                       // Registry order of the next vehicle.
+    std::size_t stepping_order = NOT_STEPPING;        // Order of the chopper / trooper being stepped.
+    std::function<bool(const Point&)> truck_filter;   // Trucks created while loading, all when empty.
+    std::vector<Trooper_Ghost> ghosts;                // Troopers of other worlds near the attacked trucks.
+    std::vector<Vehicle_Report>* reports = nullptr;   // Kept truck errors, printed when null.
+
+    struct Finished {
+        Handle truck;                                 // Finished truck, stale once archived.
+        long seconds;                                 // Simulation clock when it went to sleep.
+        std::size_t mark;                             // Finished mark of the truck, stale once the truck's differs.
+    };
+    std::deque<Finished> finished;                    // Trucks gone to sleep while archiving, oldest first.
+    std::size_t finished_count = 0;                   // Entries of finished that are not stale.
+    std::size_t last_finished_mark = 0;               // Mark of the newest entry.
+    Truck_Archive archive;                            // Retired trucks.
+    int archive_age = -1;                             // Hours a truck stays finished before it is archived, -1 off.
+    std::size_t archive_limit = ARCHIVE_NO_LIMIT;     // Finished trucks kept live.
+    std::vector<Warehouse*> warehouses;               // Warehouses by index, owned by sim_obj_list.
+    std::unordered_map<std::string_view, Warehouse*> warehouse_names;   // Warehouses by name, keys view their names.
+    Route_Table route_table;                          // Distances and courses between warehouses.
+    bool routes_dirty = true;                         // Warehouses changed since the last build.
+    std::unordered_map<std::size_t, std::shared_ptr<const std::vector<std::size_t>>> patrol_tours; // By origin.
+
+    Scenario scenario;                    // Records of everything loaded from files.
+    std::unique_ptr<Output_Sink> sink;    // Installed output sink, stdout when null.
+    mutable std::ostream output;          // Status, map, events and errors, writes into the sink.
+    std::unique_ptr<Telemetry_Writer> telemetry;  // Active recording, if any.
+    Proximity_Detector proximity;         // Entered / left radius events between vehicles.
+    std::shared_ptr<const World_Snapshot> snapshot;  // Published snapshot, only accessed atomically.
+    std::shared_ptr<const World_Snapshot> front;     // Published snapshot, its names are shared by the next one.
+    std::unique_ptr<Query_Server> query_server;      // Active query server, if any.
+    std::unique_ptr<Position_Feed> feed;             // Active shared memory position feed, if any.
+    std::ofstream checksum_log;                      // Checksum after every step, when open.
+    std::size_t registry_version = 0;     // Bumped on every change of sim_obj_list.
 
     int time = 0;                         // Simulation time.
-    std::time_t sim_time;                // System time.
+    long sim_seconds = 0;                 // Simulation clock, seconds since 00:00 of the first day.
+    int tick_seconds = SECONDS_PER_HOUR; // Length of one sub-step in seconds.
+    int deliveries = 0;                   // Truck arrivals at warehouses.
 };
 
 #endif //MODEL_H
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "Output_Sink.h"
+#include <algorithm>
+#include "SimulationException.h"
+
+Output_Sink::Output_Sink() : buffer(OUTPUT_BUFFER_SIZE) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+std::string Output_Sink::retained() const {
+    return {};
+}
+
+Output_Sink::int_type Output_Sink::overflow(const int_type c) {
+    drain();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int Output_Sink::sync() {
+    drain();
+    return 0;
+}
+
+void Output_Sink::drain() {
+    if (pptr() != pbase())
+        write(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+File_Sink::File_Sink(const std::string& file_name) : file(file_name) {
+    if (!file.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+}
+
+File_Sink::~File_Sink() {
+    drain();
+}
+
+void File_Sink::write(const char* data, const std::size_t size) {
+    file.write(data, static_cast<std::streamsize>(size));
+}
+
+Ring_Sink::Ring_Sink(const std::size_t capacity) {
+    if (capacity == 0)
+        throw InvalidArgumentException("Error: Ring size must be positive");
+    ring.resize(capacity);
+}
+
+Ring_Sink::~Ring_Sink() {
+    drain();
+}
+
+std::string Ring_Sink::retained() const {
+    if (!wrapped)
+        return ring.substr(0, next);
+    return ring.substr(next) + ring.substr(0, next);
+}
+
+// Only the last capacity bytes of a long write can survive, the rest is skipped.
+void Ring_Sink::write(const char* data, std::size_t size) {
+    if (size >= ring.size()) {
+        data += size - ring.size();
+        size = ring.size();
+    }
+    const std::size_t first = std::min(size, ring.size() - next);
+    ring.replace(next, first, data, first);
+    ring.replace(0, size - first, data + first, size - first);
+    if (next + size >= ring.size())
+        wrapped = true;
+    next = (next + size) % ring.size();
+}
+
+Async_Sink::Async_Sink(std::streambuf* _target) : target(_target), writer(&Async_Sink::run, this) {}
+
+Async_Sink::~Async_Sink() {
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();
+}
+
+void Async_Sink::write(const char* data, const std::size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    space.wait(lock, [this] { return pending.size() < ASYNC_OUTPUT_LIMIT; });
+    const bool was_empty = pending.empty();
+    pending.append(data, size);
+    lock.unlock();
+    if (was_empty)
+        ready.notify_one();
+}
+
+// The block is swapped out, so the simulation appends to an empty string while the writer writes.
+void Async_Sink::run() {
+    std::string writing;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            writing.swap(pending);
+        }
+        space.notify_one();
+        target->sputn(writing.data(), static_cast<std::streamsize>(writing.size()));
+        target->pubsync();
+        writing.clear();
+    }
+}
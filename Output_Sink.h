@@ -0,0 +1,121 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef OUTPUT_BUFFER_SIZE
+#define OUTPUT_BUFFER_SIZE 65536                // Bytes formatted before a sink takes them (-DOUTPUT_BUFFER_SIZE=...).
+#endif
+#ifndef RING_OUTPUT_LIMIT
+#define RING_OUTPUT_LIMIT (256 << 20)           // Largest ring sink in bytes (output ring <bytes>).
+#endif
+#ifndef ASYNC_OUTPUT_LIMIT
+#define ASYNC_OUTPUT_LIMIT (64 << 20)           // Bytes an async sink holds before the simulation waits for it.
+#endif
+
+/**
+ * Output_Sink class
+ * Destination of everything the simulation prints (status, map, events and errors), installed with Model::set_sink.
+ * A sink is a stream buffer: text is formatted into a fixed buffer and handed to write() when the buffer is full
+ * or the stream is flushed (std::endl), so a line costs a copy and no system call.
+ * Without a sink the Model prints to stdout.
+ */
+class Output_Sink : public std::streambuf {
+public:
+    Output_Sink();                                      // Set up the format buffer.
+    ~Output_Sink() override = default;                  // Derived sinks drain before their members go.
+    Output_Sink(const Output_Sink&) = delete;
+    Output_Sink& operator=(const Output_Sink&) = delete;
+
+    virtual std::string retained() const;               // Text kept in memory, passed on to the next sink.
+
+protected:
+    virtual void write(const char* data, std::size_t size) = 0;    // Take formatted text.
+    int_type overflow(int_type c) override;             // Buffer full.
+    int sync() override;                                // Stream flushed.
+    void drain();                                       // Hand the buffered text to write().
+
+private:
+    std::vector<char> buffer;                           // Format buffer, OUTPUT_BUFFER_SIZE bytes.
+};
+
+/**
+ * Null_Sink class
+ * Discards everything, benchmarks measure the simulation without formatting reaching any device.
+ */
+class Null_Sink final : public Output_Sink {
+protected:
+    void write(const char*, std::size_t) override {}
+};
+
+/**
+ * File_Sink class
+ * Writes into a file through its own buffer, flushes only reach the file buffer.
+ */
+class File_Sink final : public Output_Sink {
+public:
+    explicit File_Sink(const std::string& file_name);   // Open the file, throws FileException.
+    ~File_Sink() override;                              // Write the rest and close.
+
+protected:
+    void write(const char* data, std::size_t size) override;
+
+private:
+    std::ofstream file;                                 // Output file.
+};
+
+/**
+ * Ring_Sink class
+ * Keeps the last capacity bytes of output in memory, older text is overwritten.
+ * When another sink replaces it, the kept text is written there.
+ */
+class Ring_Sink final : public Output_Sink {
+public:
+    explicit Ring_Sink(std::size_t capacity);           // Capacity in bytes, throws InvalidArgumentException if 0.
+    ~Ring_Sink() override;
+
+    std::string retained() const override;              // Kept text, oldest first.
+
+protected:
+    void write(const char* data, std::size_t size) override;
+
+private:
+    std::string ring;                                   // Circular text storage.
+    std::size_t next = 0;                               // Position of the next byte.
+    bool wrapped = false;                               // The ring was filled at least once.
+};
+
+/**
+ * Async_Sink class
+ * Hands the text to a writer thread, the simulation thread only appends to a pending block under a lock.
+ * The writer swaps the block out and writes it to the target, so output keeps its order.
+ * Above ASYNC_OUTPUT_LIMIT pending bytes the simulation waits for the writer.
+ */
+class Async_Sink final : public Output_Sink {
+public:
+    explicit Async_Sink(std::streambuf* target);        // Start the writer thread.
+    ~Async_Sink() override;                             // Write everything pending and join.
+
+protected:
+    void write(const char* data, std::size_t size) override;
+
+private:
+    void run();                                         // Writer thread.
+
+    std::streambuf* target;                             // Where the text goes, only used by the writer.
+    std::mutex mutex;                                   // Guards pending and stopping.
+    std::condition_variable ready;                      // Text pending or stopping.
+    std::condition_variable space;                      // Pending fell under the limit.
+    std::string pending;                                // Text not yet taken by the writer.
+    bool stopping = false;                              // Writer exits once pending is empty.
+    std::thread writer;                                 // Started last.
+};
+
+#endif //OUTPUT_SINK_H
@@ -0,0 +1,86 @@
+#include "Position_Feed.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "Sim_Types.h"
+#include "SimulationException.h"
+#include "Vehicle.h"
+
+Position_Feed::Position_Feed(const std::string& _name) : name(_name.empty() || _name[0] != '/' ? "/" + _name : _name) {
+    fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0)
+        throw FileException("Error: Could not create shared memory <" + name + ">");
+    try {
+        map(FEED_MIN_CAPACITY);
+    } catch (...) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw;
+    }
+    new (&header->sequence) std::atomic<std::uint32_t>(0);
+    std::memcpy(header->magic, FEED_MAGIC, sizeof header->magic);
+    header->version = FEED_VERSION;
+    header->capacity = static_cast<std::uint32_t>(capacity);
+}
+
+Position_Feed::~Position_Feed() {
+    ::munmap(header, feed_size(capacity));
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+}
+
+// Growing keeps the content, readers still hold the old size until they map again.
+void Position_Feed::map(const std::size_t _capacity) {
+    if (::ftruncate(fd, static_cast<off_t>(feed_size(_capacity))) != 0)
+        throw FileException("Error: Could not size shared memory <" + name + ">");
+    void* mapped = ::mmap(nullptr, feed_size(_capacity), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED)
+        throw FileException("Error: Could not map shared memory <" + name + ">");
+    if (header)
+        ::munmap(header, feed_size(capacity));
+    header = static_cast<Feed_Header*>(mapped);
+    capacity = _capacity;
+}
+
+void Position_Feed::publish(const int time, const long seconds, const std::list<std::shared_ptr<Sim_Obj>>& objects) {
+    std::size_t needed = capacity;
+    while (needed < objects.size())
+        needed *= 2;
+    // Grow before the sequence turns odd, a failed map leaves the last frame readable.
+    if (needed != capacity)
+        map(needed);
+    const std::uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->capacity = static_cast<std::uint32_t>(capacity);
+    auto* records = reinterpret_cast<Feed_Record*>(header + 1);
+    std::size_t i = 0;
+    for (const auto& obj : objects) {
+        Feed_Record& record = records[i++];
+        const Point location = obj->get_location();
+        record.x = static_cast<float>(location.x);
+        record.y = static_cast<float>(location.y);
+        record.kind = static_cast<std::uint8_t>(obj->get_kind());
+        if (const auto* vehicle = sim_cast<Vehicle>(obj.get())) {
+            record.course = static_cast<float>(vehicle->get_course());
+            record.speed = static_cast<float>(vehicle->get_speed());
+            record.status = static_cast<std::uint8_t>(vehicle->get_status());
+        } else {
+            record.course = record.speed = 0;
+            record.status = 0;
+        }
+        const std::string& object_name = obj->get_name();
+        const std::size_t length = std::min<std::size_t>(object_name.size(), FEED_NAME_LENGTH);
+        std::memcpy(record.name, object_name.data(), length);
+        record.name[length] = '\0';
+    }
+    header->count = static_cast<std::uint32_t>(i);
+    header->time = time;
+    header->seconds = seconds;
+
+    header->sequence.store(sequence + 2, std::memory_order_release);
+}
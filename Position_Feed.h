@@ -0,0 +1,73 @@
+#ifndef POSITION_FEED_H
+#define POSITION_FEED_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include "Sim_Obj.h"
+
+#define FEED_MAGIC "VPOS"                       // Segment starts with the magic and the version.
+#define FEED_VERSION 1
+#define FEED_NAME_LENGTH 23                     // Longer names are cut in the feed.
+#define FEED_MIN_CAPACITY 1024                  // Records of a new segment, it doubles when full.
+
+/**
+ * Shared memory layout of the position feed, used by the writer and the reader tool.
+ * The header sequence is a seqlock: odd while the writer updates the segment. A reader reads the sequence,
+ * the header and the records in place, then reads the sequence again, and uses the frame only if it was even
+ * and did not change. When capacity grows past the size the reader mapped, it maps the segment again.
+ */
+struct Feed_Header {
+    char magic[4];
+    std::uint32_t version;
+    std::atomic<std::uint32_t> sequence;        // Seqlock, odd while a frame is written.
+    std::uint32_t capacity;                     // Records the segment holds.
+    std::uint32_t count;                        // Records of the current frame.
+    std::int32_t time;                          // Simulation time (hours).
+    std::int64_t seconds;                       // Simulation clock, seconds since 00:00 of the first day.
+};
+
+struct Feed_Record {
+    float x;
+    float y;
+    float course;                               // Vehicles only.
+    float speed;                                // Vehicles only.
+    std::uint8_t kind;                          // Sim_Obj::Kind.
+    std::uint8_t status;                        // Vehicle status, 0 for warehouses.
+    char name[FEED_NAME_LENGTH + 1];            // Zero terminated.
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "The seqlock must work across processes");
+
+inline std::size_t feed_size(const std::size_t capacity) {  // Bytes of a segment with capacity records.
+    return sizeof(Feed_Header) + capacity * sizeof(Feed_Record);
+}
+
+/**
+ * Position_Feed class
+ * Publishes the position, type and status of every object into a POSIX shared memory segment (feed <name>),
+ * so a local visualiser can map it and follow the simulation without parsing the map output.
+ * tools/feed_reader.cpp is a reference reader.
+ */
+class Position_Feed {
+public:
+    explicit Position_Feed(const std::string& name);            // Create the segment, throws FileException.
+    ~Position_Feed();                                           // Unmap and unlink the segment.
+    Position_Feed(const Position_Feed&) = delete;
+    Position_Feed& operator=(const Position_Feed&) = delete;
+
+    void publish(int time, long seconds, const std::list<std::shared_ptr<Sim_Obj>>& objects);  // Write one frame.
+
+private:
+    void map(std::size_t capacity);             // Size the segment and map it.
+
+    std::string name;                           // Segment name, starts with '/'.
+    int fd = -1;                                // Segment descriptor.
+    Feed_Header* header = nullptr;              // Mapped segment.
+    std::size_t capacity = 0;                   // Records mapped.
+};
+
+#endif //POSITION_FEED_H
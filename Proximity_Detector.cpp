@@ -0,0 +1,228 @@
+#include "Proximity_Detector.h"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <unordered_map>
+#include "Chopper.h"
+#include "StateTrooper.h"
+#include "Truck.h"
+
+static const char* const KIND_NAMES[] = {"Truck", "Chopper", "State_trooper"};
+
+static std::uint64_t pack_handle(const Handle handle) {
+    return (static_cast<std::uint64_t>(handle.index) << 32) | handle.generation;
+}
+
+std::size_t Proximity_Detector::Pair_Hash::operator()(const std::pair<Handle, Handle>& pair) const {
+    const std::size_t a = std::hash<std::uint64_t>()(pack_handle(pair.first));
+    return a ^ (std::hash<std::uint64_t>()(pack_handle(pair.second)) + 0x9e3779b97f4a7c15ULL + (a << 6) + (a >> 2));
+}
+
+int Proximity_Detector::kind_from_name(const std::string& name) {
+    for (int kind = 0; kind < Kinds; ++kind)
+        if (name == KIND_NAMES[kind])
+            return kind;
+    return -1;
+}
+
+void Proximity_Detector::add_rule(const int first, const int second, const double _radius) {
+    radius[first][second] = radius[second][first] = _radius;
+    max_radius = 0;
+    for (const auto& row : radius)
+        for (const double r : row)
+            max_radius = std::max(max_radius, r);
+    built = false;              // Watched types may have changed, rebuild on the next step.
+    contacts.clear();
+}
+
+void Proximity_Detector::clear() {
+    for (auto& row : radius)
+        for (double& r : row)
+            r = 0;
+    max_radius = 0;
+    built = false;
+    entries.clear();
+    order.clear();
+    contacts.clear();
+}
+
+bool Proximity_Detector::is_active() const {
+    return max_radius > 0;
+}
+
+void Proximity_Detector::rebuild(const std::list<std::shared_ptr<Sim_Obj>>& objects) {
+    entries.clear();
+    for (const auto& obj : objects) {
+        const Sim_Obj* raw = obj.get();
+        int kind;
+        switch (raw->get_kind()) {
+            case Sim_Obj::Truck_Kind: kind = Truck_Kind; break;
+            case Sim_Obj::Chopper_Kind: kind = Chopper_Kind; break;
+            case Sim_Obj::Trooper_Kind: kind = Trooper_Kind; break;
+            default: continue;
+        }
+        bool used = false;
+        for (const double r : radius[kind])
+            used = used || r > 0;
+        if (used)
+            entries.push_back({static_cast<const Vehicle*>(raw), raw->get_handle(), kind, 0, 0});
+    }
+    order.resize(entries.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+}
+
+// Gives up once the shifts pass the budget, the order is still a permutation then and full_sort finishes it.
+bool Proximity_Detector::insertion_sort() {
+    const std::size_t count = order.size();
+    const std::size_t budget = count * PROXIMITY_SORT_SHIFTS;
+    std::size_t shifts = 0;
+    for (std::size_t i = 1; i < count; ++i) {
+        const std::size_t moving = order[i];
+        const double x = sorted_x[i];
+        std::size_t j = i;
+        for (; j > 0 && sorted_x[j - 1] > x; --j) {
+            order[j] = order[j - 1];
+            sorted_x[j] = sorted_x[j - 1];
+        }
+        order[j] = moving;
+        sorted_x[j] = x;
+        shifts += i - j;
+        if (shifts > budget)
+            return false;
+    }
+    return true;
+}
+
+void Proximity_Detector::full_sort() {
+    std::sort(order.begin(), order.end(), [this](const std::size_t a, const std::size_t b) {
+        return entries[a].x < entries[b].x;
+    });
+    for (std::size_t i = 0; i < order.size(); ++i)
+        sorted_x[i] = entries[order[i]].x;
+}
+
+std::unordered_map<std::uint64_t, std::size_t> Proximity_Detector::entry_positions() const {
+    std::unordered_map<std::uint64_t, std::size_t> position;
+    for (std::size_t i = 0; i < entries.size(); ++i)
+        position[pack_handle(entries[i].handle)] = i;
+    return position;
+}
+
+void Proximity_Detector::detect(const int time, const std::list<std::shared_ptr<Sim_Obj>>& objects,
+                                const std::size_t registry_version, std::ostream& out) {
+    if (!is_active())
+        return;
+
+    const bool rebuilt = !built || built_version != registry_version;
+    if (rebuilt) {
+        rebuild(objects);
+        built = true;
+        built_version = registry_version;
+    }
+
+    for (auto& entry : entries) {
+        const Point location = entry.vehicle->get_location();
+        entry.x = location.x;
+        entry.y = location.y;
+    }
+
+    // A new vehicle set is sorted once, afterwards the previous order is nearly sorted
+    // since vehicles move little per step, and insertion sort fixes it in close to linear time.
+    const std::size_t count = order.size();
+    sorted_x.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        sorted_x[i] = entries[order[i]].x;
+    if (rebuilt || !insertion_sort())
+        full_sort();
+    sorted_y.resize(count);
+    sorted_kind.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        sorted_y[i] = entries[order[i]].y;
+        sorted_kind[i] = entries[order[i]].kind;
+    }
+
+    // Sweep over the sorted columns: only pairs closer than the largest radius in x reach the distance check.
+    std::vector<Contact> found;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double ax = sorted_x[i], ay = sorted_y[i];
+        const double* rules = radius[sorted_kind[i]];
+        for (std::size_t j = i + 1; j < count; ++j) {
+            const double dx = sorted_x[j] - ax;
+            if (dx > max_radius) break;
+            const double r = rules[sorted_kind[j]];
+            const double dy = sorted_y[j] - ay;
+            if (r <= 0 || dy > r || -dy > r || dx * dx + dy * dy > r * r) continue;
+            // The pair is printed type first (Truck, Chopper, State_trooper), then registry order.
+            std::size_t first = order[i], second = order[j];
+            if (entries[first].kind > entries[second].kind ||
+                (entries[first].kind == entries[second].kind && first > second))
+                std::swap(first, second);
+            found.push_back({first, second});
+        }
+    }
+
+    // Events in registry order of the pairs, so the output does not depend on the sweep order.
+    std::vector<Contact> entered, left;
+    decltype(contacts) now;
+    now.reserve(found.size());
+    for (const auto& contact : found) {
+        const auto key = std::make_pair(entries[contact.first].handle, entries[contact.second].handle);
+        now.insert(key);
+        if (!contacts.count(key))
+            entered.push_back(contact);
+    }
+    if (contacts.size() + entered.size() != now.size()) {     // Some pair parted.
+        const auto position = entry_positions();
+        for (const auto& key : contacts) {
+            if (now.count(key)) continue;
+            const auto first = position.find(pack_handle(key.first)), second = position.find(pack_handle(key.second));
+            if (first != position.end() && second != position.end())
+                left.push_back({first->second, second->second});
+        }
+    }
+    contacts.swap(now);
+
+    print_events(time, "entered", entered, out);
+    print_events(time, "left", left, out);
+}
+
+// The entries still hold the retired vehicles and the handles they had, their slots may be released already.
+// Entries are rebuilt on the next step since the registry changed.
+void Proximity_Detector::retire(const int time, const std::unordered_set<const Sim_Obj*>& retired, std::ostream& out) {
+    if (contacts.empty())
+        return;
+    std::unordered_set<std::uint64_t> gone;
+    for (const auto& entry : entries)
+        if (retired.count(entry.vehicle))
+            gone.insert(pack_handle(entry.handle));
+    const auto position = entry_positions();
+    std::vector<Contact> left;
+    for (auto it = contacts.begin(); it != contacts.end();) {
+        if (!gone.count(pack_handle(it->first)) && !gone.count(pack_handle(it->second))) {
+            ++it;
+            continue;
+        }
+        const auto first = position.find(pack_handle(it->first)), second = position.find(pack_handle(it->second));
+        if (first != position.end() && second != position.end())
+            left.push_back({first->second, second->second});
+        it = contacts.erase(it);
+    }
+    print_events(time, "left", left, out);
+}
+
+void Proximity_Detector::print_events(const int time, const char* verb, std::vector<Contact>& events,
+                                      std::ostream& out) const {
+    std::sort(events.begin(), events.end(), [](const Contact& a, const Contact& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+    char distance[32];
+    for (const auto& contact : events) {
+        const Entry& a = entries[contact.first];
+        const Entry& b = entries[contact.second];
+        std::snprintf(distance, sizeof(distance), "%.2f", radius[a.kind][b.kind]);
+        out << "Proximity at time " << time << ": " << KIND_NAMES[a.kind] << " " << a.vehicle->get_name()
+            << " " << verb << " " << distance << " km of " << KIND_NAMES[b.kind] << " "
+            << b.vehicle->get_name() << std::endl;
+    }
+}
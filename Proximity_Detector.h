@@ -0,0 +1,76 @@
+#ifndef PROXIMITY_DETECTOR_H
+#define PROXIMITY_DETECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Sim_Obj.h"
+
+#ifndef PROXIMITY_SORT_SHIFTS
+#define PROXIMITY_SORT_SHIFTS 8         // Insertion sort shifts per vehicle before a step sorts from scratch (-DPROXIMITY_SORT_SHIFTS=...).
+#endif
+
+class Vehicle;
+
+/**
+ * Proximity_Detector class
+ * Reports when two vehicles of a configured pair of types come within a radius of each other, and when they part.
+ * Broad phase is sort and sweep on x: vehicles stay sorted by x between steps and are re-sorted by insertion,
+ * which is close to linear while vehicles move a little per step. A step that reorders more than that (long ticks,
+ * many crossings) falls back to a full sort. Only pairs closer than the largest radius in x are checked further,
+ * so there is no all-pairs pass.
+ */
+class Proximity_Detector {
+public:
+    enum Kind {Truck_Kind, Chopper_Kind, Trooper_Kind, Kinds};
+
+    static int kind_from_name(const std::string& name);        // "Truck", "Chopper", "State_trooper", -1 otherwise.
+    void add_rule(int first, int second, double radius);      // Watch a pair of types, replaces their radius.
+    void clear();                                              // Remove every rule and contact.
+    bool is_active() const;                                    // Any rule configured?
+
+    // Find the contacts of this step and print the entered / left events.
+    // Vehicles are classified again only when the registry version changed.
+    void detect(int time, const std::list<std::shared_ptr<Sim_Obj>>& objects, std::size_t registry_version,
+                std::ostream& out);
+    // Print the left events of vehicles about to leave the world and drop their contacts, call before they are freed.
+    void retire(int time, const std::unordered_set<const Sim_Obj*>& retired, std::ostream& out);
+
+private:
+    struct Entry {
+        const Vehicle* vehicle;     // Watched vehicle.
+        Handle handle;              // Its handle, contacts are keyed by it and outlive a freed address.
+        int kind;                   // Its type.
+        double x, y;                // Position of this step.
+    };
+    struct Contact {
+        std::size_t first, second;  // Indices into entries, first is printed first.
+    };
+    struct Pair_Hash {
+        std::size_t operator()(const std::pair<Handle, Handle>& pair) const;
+    };
+
+    void rebuild(const std::list<std::shared_ptr<Sim_Obj>>& objects);   // Vehicle set changed.
+    bool insertion_sort();                  // Fix the previous order, false if it took too many shifts.
+    void full_sort();                       // Sort the order from scratch.
+    std::unordered_map<std::uint64_t, std::size_t> entry_positions() const;    // Entry index by packed handle.
+    void print_events(int time, const char* verb, std::vector<Contact>& events, std::ostream& out) const;
+
+    double radius[Kinds][Kinds] = {};       // Radius per pair of types, 0 when not watched.
+    double max_radius = 0;                  // Sweep window.
+    bool built = false;                     // Entries match the registry version below.
+    std::size_t built_version = 0;          // Registry version of the entries.
+    std::vector<Entry> entries;             // Vehicles of the watched types, in registry order.
+    std::vector<std::size_t> order;         // Entry indices sorted by x, kept between steps.
+    std::vector<double> sorted_x, sorted_y; // Positions in sorted order, swept without indirection.
+    std::vector<int> sorted_kind;           // Types in sorted order.
+    std::unordered_set<std::pair<Handle, Handle>, Pair_Hash> contacts;     // Pairs in range.
+};
+
+#endif //PROXIMITY_DETECTOR_H
@@ -0,0 +1,117 @@
+#include "Query_Server.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Model.h"
+#include "SimulationException.h"
+
+Query_Server::Query_Server(const Model& _model, std::string _path) : model(_model), path(std::move(_path)) {
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof address.sun_path)
+        throw InvalidArgumentException("Error: Socket path <" + path + "> is not valid");
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw FileException("Error: Could not create socket <" + path + ">");
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof address) != 0 ||
+        ::listen(listener, QUERY_THREADS * 4) != 0) {
+        ::close(listener);
+        throw FileException("Error: Could not listen on socket <" + path + ">");
+    }
+    for (int i = 0; i < QUERY_THREADS; ++i)
+        workers.emplace_back(&Query_Server::serve, this);
+}
+
+// Shutting the sockets down wakes workers blocked in accept or recv.
+Query_Server::~Query_Server() {
+    stopping = true;
+    ::shutdown(listener, SHUT_RDWR);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const int client : clients)
+            ::shutdown(client, SHUT_RDWR);
+    }
+    for (auto& worker : workers)
+        worker.join();
+    ::close(listener);
+    ::unlink(path.c_str());
+}
+
+void Query_Server::serve() {
+    while (!stopping) {
+        const int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (stopping) return;
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                ::close(client);
+                return;
+            }
+            clients.push_back(client);
+        }
+        answer(client);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            clients.erase(std::find(clients.begin(), clients.end(), client));
+        }
+        ::close(client);
+    }
+}
+
+void Query_Server::answer(const int client) {
+    std::string pending;
+    char buffer[1024];
+    while (true) {
+        const ssize_t received = ::recv(client, buffer, sizeof buffer, 0);
+        if (received <= 0) return;
+        pending.append(buffer, static_cast<std::size_t>(received));
+
+        std::size_t end;
+        while ((end = pending.find('\n')) != std::string::npos) {
+            std::string_view request(pending.data(), end);
+            if (!request.empty() && request.back() == '\r')
+                request.remove_suffix(1);
+            const std::string response = reply(request);
+            for (std::size_t sent = 0; sent < response.size();) {
+                const ssize_t n = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) return;
+                sent += static_cast<std::size_t>(n);
+            }
+            pending.erase(0, end + 1);
+        }
+        if (pending.size() > QUERY_MAX_REQUEST) return;
+    }
+}
+
+std::string Query_Server::reply(const std::string_view request) const {
+    const std::shared_ptr<const World_Snapshot> snapshot = model.get_snapshot();
+    std::ostringstream out;
+    if (!snapshot) {
+        out << "Error: No snapshot published\n";
+    } else if (request == "status") {
+        for (std::size_t i = 0; i < snapshot->entries.size(); ++i)
+            snapshot->print(out, i);
+    } else if (request.substr(0, 7) == "status ") {
+        const std::size_t index = snapshot->find(request.substr(7));
+        if (index == snapshot->entries.size())
+            out << "Error: <" << request.substr(7) << "> not found\n";
+        else
+            snapshot->print(out, index);
+    } else if (request == "time") {
+        out << "Time " << snapshot->time << ", " << snapshot->minute_of_day / 60 / 10 << snapshot->minute_of_day / 60 % 10
+            << ":" << snapshot->minute_of_day % 60 / 10 << snapshot->minute_of_day % 10 << "\n";
+    } else {
+        out << "Error: Unknown query, use status, status <name> or time\n";
+    }
+    out << "\n";
+    return out.str();
+}
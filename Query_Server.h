@@ -0,0 +1,49 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef QUERY_THREADS
+#define QUERY_THREADS 2                 // Connections answered at once (-DQUERY_THREADS=...).
+#endif
+#define QUERY_MAX_REQUEST 256           // Longest request line, longer lines close the connection.
+
+class Model;
+
+/**
+ * Query_Server class
+ * Local Unix domain socket server answering read-only queries from the latest World_Snapshot of a Model.
+ * Each worker thread accepts and serves one connection at a time, requests are lines and every reply
+ * ends with an empty line:
+ *   status            every object, like the status command
+ *   status <name>     one object
+ *   time              simulation time and clock of the snapshot
+ * Workers only take a reference to the published snapshot, the simulation thread never waits for them.
+ */
+class Query_Server {
+public:
+    Query_Server(const Model& model, std::string path);    // Bind the socket and start the workers.
+    ~Query_Server();                                        // Close every connection, join, remove the socket.
+    Query_Server(const Query_Server&) = delete;
+    Query_Server& operator=(const Query_Server&) = delete;
+
+private:
+    void serve();                                           // Worker, accepts connections until stopped.
+    void answer(int client);                                // Reply to every request of one connection.
+    std::string reply(std::string_view request) const;      // Reply to one request.
+
+    const Model& model;                                     // World whose snapshots are served.
+    std::string path;                                       // Socket path.
+    int listener = -1;                                      // Listening socket.
+    std::atomic<bool> stopping{false};                      // Workers exit.
+    std::mutex mutex;                                       // Guards clients.
+    std::vector<int> clients;                               // Open connections, shut down on stop.
+    std::vector<std::thread> workers;                       // QUERY_THREADS workers.
+};
+
+#endif //QUERY_SERVER_H
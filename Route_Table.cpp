@@ -0,0 +1,53 @@
+#include "Route_Table.h"
+
+// Values come from calculate_distance / calculate_course_deg, so they are identical to computing them in place.
+void Route_Table::build(const std::vector<Point>& locations) {
+    points = locations;
+    lru.clear();
+    cached.clear();
+    dense.clear();
+
+    const std::size_t w = points.size();
+    if (w > DENSE_ROUTE_LIMIT)
+        return;
+    dense.resize(w * w);
+    for (std::size_t from = 0; from < w; ++from) {
+        for (std::size_t to = 0; to < w; ++to) {
+            dense[from * w + to] = {calculate_distance(points[from], points[to]),
+                                    calculate_course_deg(points[from], points[to])};
+        }
+    }
+}
+
+bool Route_Table::is_dense() const {
+    return dense.size() == points.size() * points.size();
+}
+
+double Route_Table::distance(const std::size_t from, const std::size_t to) {
+    return lookup(from, to).distance;
+}
+
+double Route_Table::course(const std::size_t from, const std::size_t to) {
+    return lookup(from, to).course;
+}
+
+const Route_Table::Route& Route_Table::lookup(const std::size_t from, const std::size_t to) {
+    if (!dense.empty())
+        return dense[from * points.size() + to];
+
+    const std::uint64_t key = static_cast<std::uint64_t>(from) * points.size() + to;
+    const auto found = cached.find(key);
+    if (found != cached.end()) {
+        lru.splice(lru.begin(), lru, found->second);    // Mark as most recent.
+        return found->second->second;
+    }
+
+    if (lru.size() >= ROUTE_CACHE_CAPACITY) {           // Evict the least recent pair.
+        cached.erase(lru.back().first);
+        lru.pop_back();
+    }
+    lru.emplace_front(key, Route{calculate_distance(points[from], points[to]),
+                                 calculate_course_deg(points[from], points[to])});
+    cached[key] = lru.begin();
+    return lru.front().second;
+}
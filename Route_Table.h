@@ -0,0 +1,48 @@
+#ifndef ROUTE_TABLE_H
+#define ROUTE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Geometry.h"
+
+#ifndef DENSE_ROUTE_LIMIT
+#define DENSE_ROUTE_LIMIT 1024          // Max warehouses for the dense W x W matrix (-DDENSE_ROUTE_LIMIT=...).
+#endif
+#ifndef ROUTE_CACHE_CAPACITY
+#define ROUTE_CACHE_CAPACITY 65536      // Max cached pairs above the limit.
+#endif
+
+/**
+ * Route_Table class
+ * Distance and course between warehouse pairs, indexed by warehouse index.
+ * Up to DENSE_ROUTE_LIMIT warehouses every pair is precomputed once, above it pairs are computed on demand
+ * and kept in an LRU cache. The limit is set at compile time, -DDENSE_ROUTE_LIMIT=<n>.
+ */
+class Route_Table {
+public:
+    void build(const std::vector<Point>& locations);    // Rebuild for the given warehouse locations.
+    bool is_dense() const;                              // Is the dense matrix in use?
+
+    double distance(std::size_t from, std::size_t to);  // Distance between two warehouses.
+    double course(std::size_t from, std::size_t to);    // Course in degrees from one warehouse to another.
+
+private:
+    struct Route {
+        double distance;
+        double course;
+    };
+    const Route& lookup(std::size_t from, std::size_t to);     // Dense entry, or cached / computed one.
+
+    std::vector<Point> points;                      // Warehouse locations by index.
+    std::vector<Route> dense;                       // Row-major W x W, empty above the limit.
+
+    using Entry = std::pair<std::uint64_t, Route>;
+    std::list<Entry> lru;                                                   // Most recent first.
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> cached;   // Pair key to LRU node.
+};
+
+#endif //ROUTE_TABLE_H
@@ -0,0 +1,49 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * SPSC_Queue class (template)
+ * Fixed capacity, lock-free queue for exactly one producer thread and one consumer thread.
+ * The producer only writes tail, the consumer only writes head, so no locks are needed.
+ */
+template<typename T, std::size_t Capacity>
+class SPSC_Queue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side, moves the value in only if there is room. Returns false when full.
+    bool try_push(T&& value) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        buffer[t & (Capacity - 1)] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, moves the front value out. Returns false when empty.
+    bool try_pop(T& out) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        out = std::move(buffer[h & (Capacity - 1)]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> buffer;                   // Ring storage.
+    alignas(64) std::atomic<std::size_t> head{0};     // Next slot to pop, written by the consumer.
+    alignas(64) std::atomic<std::size_t> tail{0};     // Next slot to push, written by the producer.
+};
+
+#endif //SPSC_QUEUE_H
@@ -0,0 +1,40 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <ios>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Details.h"
+
+class Scenario_Bundle;
+
+/**
+ * Scenario structures
+ * Validated content of the depot and truck files, kept by Model so the same scenario
+ * can be loaded into other Model instances without reading and validating the files again.
+ * A scenario loaded from a compiled bundle keeps its warehouses as records and its trucks in the bundle.
+ */
+struct WarehouseRecord {
+    std::string name;
+    int inventory;
+    float x;
+    float y;
+};
+
+struct TruckRecord {
+    std::string name;
+    std::list<Details> path;    // Every stop, the first one is the source warehouse.
+    int crates;                 // Total crates loaded at the source warehouse.
+    std::string stream_file;    // Set for a streamed schedule, path then holds only the source.
+    std::streamoff stream_offset = 0;   // Offset of the first stop line in stream_file.
+};
+
+struct Scenario {
+    std::vector<WarehouseRecord> warehouses;
+    std::vector<TruckRecord> trucks;
+    std::shared_ptr<const Scenario_Bundle> bundle;  // Compiled trucks loaded with -b, shared by all worlds.
+};
+
+#endif //SCENARIO_H
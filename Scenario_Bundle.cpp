@@ -0,0 +1,167 @@
+#include "Scenario_Bundle.h"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include "SimulationException.h"
+
+static_assert(std::is_trivially_copyable_v<Scenario_Bundle::Truck_Entry> &&
+              std::is_trivially_copyable_v<Scenario_Bundle::Leg_Entry>, "Bundle records are written as raw bytes");
+
+// Sections start on 8 byte boundaries so the records can be used in place.
+static std::size_t align8(const std::size_t offset) {
+    return (offset + 7) & ~static_cast<std::size_t>(7);
+}
+
+Scenario_Bundle::Name Scenario_Bundle::Builder::intern(const std::string_view text) {
+    const auto found = interned.find(std::string(text));
+    if (found != interned.end())
+        return found->second;
+    const Name name{static_cast<std::uint32_t>(pool.size()), static_cast<std::uint32_t>(text.size())};
+    pool.append(text);
+    interned.emplace(std::string(text), name);
+    return name;
+}
+
+void Scenario_Bundle::Builder::write(const std::string& file_name) const {
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+
+    Header header{};
+    std::memcpy(header.magic, BUNDLE_MAGIC, sizeof header.magic);
+    header.version = BUNDLE_VERSION;
+    header.warehouse_count = static_cast<std::uint32_t>(warehouses.size());
+    header.truck_count = static_cast<std::uint32_t>(trucks.size());
+    header.leg_count = static_cast<std::uint32_t>(legs.size());
+    header.pool_size = static_cast<std::uint32_t>(pool.size());
+
+    static const char padding[8] = {};
+    const std::size_t warehouse_end = sizeof header + warehouses.size() * sizeof(Warehouse_Entry);
+    file.write(reinterpret_cast<const char*>(&header), sizeof header);
+    file.write(reinterpret_cast<const char*>(warehouses.data()),
+               static_cast<std::streamsize>(warehouses.size() * sizeof(Warehouse_Entry)));
+    file.write(padding, static_cast<std::streamsize>(align8(warehouse_end) - warehouse_end));
+    file.write(reinterpret_cast<const char*>(trucks.data()),
+               static_cast<std::streamsize>(trucks.size() * sizeof(Truck_Entry)));
+    file.write(reinterpret_cast<const char*>(legs.data()), static_cast<std::streamsize>(legs.size() * sizeof(Leg_Entry)));
+    file.write(pool.data(), static_cast<std::streamsize>(pool.size()));
+    if (!file)
+        throw FileException("Error: Could not write file <" + file_name + ">");
+}
+
+Scenario_Bundle::Scenario_Bundle(const std::string& file_name) {
+    const int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw FileException("Error: Could not open file <" + file_name + ">");
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        throw FileException("Error: <" + file_name + "> is not a scenario bundle");
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        throw FileException("Error: Could not map file <" + file_name + ">");
+    data = static_cast<const unsigned char*>(mapped);
+    header = reinterpret_cast<const Header*>(data);
+    try {
+        check(file_name);
+    } catch (...) {
+        ::munmap(const_cast<unsigned char*>(data), size);
+        throw;
+    }
+    pool = reinterpret_cast<const char*>(legs() + header->leg_count);
+    try {
+        check_streams(file_name);
+    } catch (...) {
+        ::munmap(const_cast<unsigned char*>(data), size);
+        throw;
+    }
+}
+
+Scenario_Bundle::~Scenario_Bundle() {
+    ::munmap(const_cast<unsigned char*>(data), size);
+}
+
+// Only structure is checked, the content was validated when the bundle was compiled.
+void Scenario_Bundle::check(const std::string& file_name) const {
+    const std::string bad = "Error: <" + file_name + "> is not a valid scenario bundle";
+    if (std::memcmp(header->magic, BUNDLE_MAGIC, sizeof header->magic) != 0 || header->version != BUNDLE_VERSION)
+        throw FileException(bad);
+
+    const std::size_t expected = align8(sizeof(Header) + header->warehouse_count * sizeof(Warehouse_Entry)) +
+                                 header->truck_count * sizeof(Truck_Entry) +
+                                 static_cast<std::size_t>(header->leg_count) * sizeof(Leg_Entry) + header->pool_size;
+    if (size != expected)
+        throw FileException(bad);
+
+    const auto name_ok = [this](const Name& name) {
+        return name.offset <= header->pool_size && name.length <= header->pool_size - name.offset;
+    };
+    const auto* warehouse = warehouses();
+    for (std::size_t i = 0; i < header->warehouse_count; ++i)
+        if (!name_ok(warehouse[i].name))
+            throw FileException(bad);
+    const auto* truck = trucks();
+    for (std::size_t i = 0; i < header->truck_count; ++i) {
+        const Truck_Entry& entry = truck[i];
+        if (!name_ok(entry.name) || !name_ok(entry.departure) || entry.origin >= header->warehouse_count ||
+            entry.leg_begin > header->leg_count || entry.leg_count > header->leg_count - entry.leg_begin ||
+            (entry.stream_file.offset != BUNDLE_NO_STREAM && !name_ok(entry.stream_file)) ||
+            (entry.stream_file.offset == BUNDLE_NO_STREAM && entry.leg_count == 0))
+            throw FileException(bad);
+    }
+    const auto* leg = legs();
+    for (std::size_t i = 0; i < header->leg_count; ++i)
+        if (leg[i].warehouse >= header->warehouse_count)
+            throw FileException(bad);
+}
+
+// Stream offsets and line numbers are only valid for the file as it was compiled.
+void Scenario_Bundle::check_streams(const std::string& file_name) const {
+    const auto* truck = trucks();
+    for (std::size_t i = 0; i < header->truck_count; ++i) {
+        if (truck[i].stream_file.offset == BUNDLE_NO_STREAM) continue;
+        const std::string stream_name(name(truck[i].stream_file));
+        if (stamp(stream_name) != truck[i].stream_stamp)
+            throw FileException("Error: <" + stream_name + "> changed since <" + file_name + "> was compiled");
+    }
+}
+
+Scenario_Bundle::File_Stamp Scenario_Bundle::stamp(const std::string& file_name) {
+    struct stat info{};
+    if (::stat(file_name.c_str(), &info) != 0)
+        throw FileException("Error: Could not open file <" + file_name + ">");
+    return {static_cast<std::int64_t>(info.st_size),
+            static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec};
+}
+
+const Scenario_Bundle::Warehouse_Entry* Scenario_Bundle::warehouses() const {
+    return reinterpret_cast<const Warehouse_Entry*>(data + sizeof(Header));
+}
+
+std::size_t Scenario_Bundle::warehouse_count() const {
+    return header->warehouse_count;
+}
+
+const Scenario_Bundle::Truck_Entry* Scenario_Bundle::trucks() const {
+    return reinterpret_cast<const Truck_Entry*>(
+        data + align8(sizeof(Header) + header->warehouse_count * sizeof(Warehouse_Entry)));
+}
+
+std::size_t Scenario_Bundle::truck_count() const {
+    return header->truck_count;
+}
+
+const Scenario_Bundle::Leg_Entry* Scenario_Bundle::legs() const {
+    return reinterpret_cast<const Leg_Entry*>(trucks() + header->truck_count);
+}
+
+std::string_view Scenario_Bundle::name(const Name& name) const {
+    return {pool + name.offset, name.length};
+}
@@ -0,0 +1,115 @@
+#ifndef SCENARIO_BUNDLE_H
+#define SCENARIO_BUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define BUNDLE_MAGIC "VSCB"                     // File starts with the magic and the version.
+#define BUNDLE_VERSION 2
+#define BUNDLE_NO_STREAM 0xFFFFFFFFu            // Truck_Entry::stream_file of a truck with all legs in the bundle.
+
+/**
+ * Scenario_Bundle class
+ * A validated scenario compiled into one binary file: warehouses, trucks with their resolved itineraries
+ * (warehouse indexes, departure minutes, speed and course of every leg) and a pool of interned names.
+ * All sections are arrays of fixed-size records read from the read-only mapping, so loading needs no parsing
+ * and no validation of the original text files. Trucks copy their legs into their own itinerary.
+ * A streamed schedule is still read from its text file, the bundle keeps its size and modification time
+ * and is rejected if the file changed since it was compiled.
+ * Writing goes through Scenario_Bundle::Builder.
+ */
+class Scenario_Bundle {
+public:
+    struct Name {
+        std::uint32_t offset;           // Start in the string pool.
+        std::uint32_t length;           // Length in bytes.
+    };
+    struct File_Stamp {
+        std::int64_t size;              // Length in bytes.
+        std::int64_t modified;          // Modification time, nanoseconds since the epoch.
+        bool operator==(const File_Stamp& other) const { return size == other.size && modified == other.modified; }
+        bool operator!=(const File_Stamp& other) const { return !(*this == other); }
+    };
+    struct Warehouse_Entry {
+        Name name;
+        std::int32_t inventory;         // Inventory before any truck loaded.
+        float x;
+        float y;
+    };
+    struct Truck_Entry {
+        Name name;
+        std::uint32_t origin;           // Warehouse index of the source.
+        std::int32_t crates;            // Crates loaded at the source.
+        double speed;                   // Speed of the first leg.
+        double course;                  // Course of the first leg.
+        std::uint32_t leg_begin;        // First leg in the leg section.
+        std::uint32_t leg_count;        // Legs in the bundle.
+        Name departure;                 // Departure from the source, used by streamed trucks.
+        Name stream_file;               // Schedule file of a streamed truck, offset BUNDLE_NO_STREAM otherwise.
+        std::int64_t stream_offset;     // Offset of the first stop line in stream_file.
+        File_Stamp stream_stamp;        // stream_file as it was compiled.
+    };
+    struct Leg_Entry {
+        std::uint32_t warehouse;        // Warehouse index of the stop.
+        std::int32_t crates;            // Crates unloaded at the stop.
+        std::int32_t departure_minute;  // Departure from the stop, minutes since 00:00.
+        std::int32_t reserved;          // Keeps the doubles aligned.
+        double speed;                   // Speed of the leg to the next stop.
+        double course;                  // Course of the leg to the next stop.
+    };
+
+    /**
+     * Builder class
+     * Collects the records of a scenario, interns every name once and writes the bundle file.
+     */
+    class Builder {
+    public:
+        Name intern(std::string_view text);                 // Add a name to the pool, once per distinct name.
+        void write(const std::string& file_name) const;     // Write the bundle, throws FileException.
+
+        std::vector<Warehouse_Entry> warehouses;            // Warehouses by index.
+        std::vector<Truck_Entry> trucks;                    // Trucks in load order.
+        std::vector<Leg_Entry> legs;                        // Legs of all trucks, each truck a contiguous range.
+
+    private:
+        std::string pool;                                   // All names, back to back.
+        std::unordered_map<std::string, Name> interned;     // Names already in the pool.
+    };
+
+    explicit Scenario_Bundle(const std::string& file_name); // Map and check a bundle, throws FileException.
+    Scenario_Bundle(const Scenario_Bundle&) = delete;
+    Scenario_Bundle& operator=(const Scenario_Bundle&) = delete;
+    ~Scenario_Bundle();                                      // Unmap the file.
+
+    const Warehouse_Entry* warehouses() const;              // Warehouse section.
+    std::size_t warehouse_count() const;
+    const Truck_Entry* trucks() const;                      // Truck section.
+    std::size_t truck_count() const;
+    const Leg_Entry* legs() const;                          // Leg section.
+    std::string_view name(const Name& name) const;          // Text of an interned name, in the mapping.
+
+    static File_Stamp stamp(const std::string& file_name);  // Size and modification time, throws FileException.
+
+private:
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t warehouse_count;
+        std::uint32_t truck_count;
+        std::uint32_t leg_count;
+        std::uint32_t pool_size;
+    };
+    void check(const std::string& file_name) const;         // Bounds of every section, name and index.
+    void check_streams(const std::string& file_name) const; // Streamed schedules unchanged since compiling.
+
+    const unsigned char* data = nullptr;                    // Mapped file.
+    std::size_t size = 0;                                   // Mapped length.
+    const Header* header = nullptr;
+    const char* pool = nullptr;                             // String pool, after the leg section.
+};
+
+#endif //SCENARIO_BUNDLE_H
@@ -0,0 +1,83 @@
+#include "Schedule_Stream.h"
+#include <fstream>
+#include <utility>
+#include "Model.h"
+#include "Shard_Channel.h"
+#include "SimulationException.h"
+
+Schedule_Stream::Schedule_Stream(std::string _file_name, const std::streamoff _offset, const int _line_number,
+                                 Warehouse* origin, std::string departure, const int crates)
+    : file_name(std::move(_file_name)), offset(_offset), line_number(_line_number),
+      pending{origin, 0, time_difference_minutes("00:00", departure), 0.0, 0.0},
+      pending_departure(std::move(departure)), remaining_crates(crates) {}
+
+// Members are initialized in declaration order, the order pack() wrote them.
+Schedule_Stream::Schedule_Stream(const Model& model, Shard_Message& message)
+    : file_name(message.get_text()), offset(message.get<std::streamoff>()), line_number(message.get<int>()),
+      pending(unpack_leg(model, message)), pending_departure(message.get_text()),
+      remaining_crates(message.get<int>()), done(message.get<bool>()) {}
+
+void Schedule_Stream::read(Model& model, std::vector<TruckLeg>& legs, const std::size_t count) {
+    if (done || count == 0) return;
+
+    std::ifstream file;
+    if (offset >= 0) {
+        file.open(file_name);
+        if (!file.is_open() || !file.seekg(offset))
+            throw FileException("Error: Could not reopen file <" + file_name + ">");
+    }
+
+    std::string line;
+    std::size_t added = 0;
+    while (added < count) {
+        if (offset < 0 || !std::getline(file, line)) {    // End of file, the pending stop is the last one.
+            legs.push_back(pending);
+            remaining_crates -= pending.crates;
+            done = true;
+            return;
+        }
+        const std::string where = "Error: " + file_name + " line " + std::to_string(line_number++) + ": ";
+        offset = file.eof() ? -1 : static_cast<std::streamoff>(file.tellg());
+        line = trim(line);
+        if (line.empty()) continue;
+
+        const auto tokens = split_line(line);
+        Warehouse* warehouse = model.find_warehouse_by_name(tokens[0]);
+        if (!warehouse)
+            throw WarehouseNotFoundException(where + "Warehouse <" + tokens[0] + "> not found");
+        if (tokens.size() != 4)
+            throw InvalidInputLineException(where + "Every other line must contain 4 arguments");
+        if (!is_valid_truck_line(tokens))
+            throw InvalidInputLineException(where + "Wrong file format");
+
+        // The new stop completes the leg of the pending one.
+        const double dist = model.get_distance(*pending.warehouse, *warehouse);
+        const int mins = time_difference_minutes(pending_departure, tokens[1]);
+        pending.speed = dist / (mins / 60.0);
+        pending.course = model.get_course(*pending.warehouse, *warehouse);
+        legs.push_back(pending);
+        remaining_crates -= pending.crates;
+        ++added;
+
+        pending = {warehouse, std::stoi(tokens[2]), time_difference_minutes("00:00", tokens[3]), 0.0, 0.0};
+        pending_departure = tokens[3];
+    }
+}
+
+bool Schedule_Stream::exhausted() const {
+    return done;
+}
+
+int Schedule_Stream::get_remaining_crates() const {
+    return remaining_crates;
+}
+
+void Schedule_Stream::pack(Shard_Message& message) const {
+    message.put_text(file_name);
+    message.put(offset);
+    message.put(line_number);
+    pack_leg(pending, message);
+    message.put_text(pending_departure);
+    message.put(remaining_crates);
+    message.put(done);
+}
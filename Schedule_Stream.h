@@ -0,0 +1,49 @@
+#ifndef SCHEDULE_STREAM_H
+#define SCHEDULE_STREAM_H
+
+#include <ios>
+#include <string>
+#include <vector>
+#include "Truck.h"
+
+#ifndef STREAM_SCHEDULE_STOPS
+#define STREAM_SCHEDULE_STOPS 4096      // Schedules with more stops are streamed (-DSTREAM_SCHEDULE_STOPS=...).
+#endif
+#ifndef SCHEDULE_WINDOW
+#define SCHEDULE_WINDOW 64              // Legs a streamed truck holds at once.
+#endif
+
+class Model;
+class Shard_Message;
+class Warehouse;
+
+/**
+ * Schedule_Stream class
+ * Reads the stops of a long truck schedule file a window at a time, so the truck only holds its next legs.
+ * The file is reopened at the saved offset on every refill, no file stays open between refills.
+ * A leg is handed out once the following stop is read, its speed and course depend on it.
+ */
+class Schedule_Stream {
+public:
+    Schedule_Stream(std::string file_name, std::streamoff offset, int line_number,
+                    Warehouse* origin, std::string departure, int crates);     // Stream positioned after the origin line.
+    Schedule_Stream(const Model& model, Shard_Message& message);   // Unpack a stream packed by another world.
+
+    // Appends up to count legs, the first one is the origin leg.
+    // Throws InvalidInputLineException with the line number on a bad line.
+    void read(Model& model, std::vector<TruckLeg>& legs, std::size_t count);
+    bool exhausted() const;                 // Every leg was handed out.
+    int get_remaining_crates() const;       // Crates of the stops not handed out yet.
+    void pack(Shard_Message& message) const;    // File, position and the pending stop.
+
+private:
+    std::string file_name;                  // Schedule file.
+    std::streamoff offset;                  // Offset of the next line to read, -1 after the last line.
+    int line_number;                        // Number of the next line to read.
+    TruckLeg pending;                       // Last stop read, its leg ends at the next stop.
+    std::string pending_departure;          // Departure time of the pending stop.
+    int remaining_crates;                   // Crates of the pending stop and every stop after it.
+    bool done = false;                      // The pending stop was the last one.
+};
+
+#endif //SCHEDULE_STREAM_H
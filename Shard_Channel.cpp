@@ -0,0 +1,107 @@
+#include "Shard_Channel.h"
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+void Shard_Message::put_text(const std::string_view text) {
+    put(static_cast<std::uint32_t>(text.size()));
+    bytes.append(text);
+}
+
+std::string Shard_Message::get_text() {
+    const auto length = get<std::uint32_t>();
+    return std::string(take(length), length);
+}
+
+void Shard_Message::put_message(const Shard_Message& other) {
+    put(static_cast<std::uint64_t>(other.bytes.size()));
+    bytes.append(other.bytes);
+}
+
+Shard_Message Shard_Message::get_message() {
+    const auto length = get<std::uint64_t>();
+    Shard_Message message;
+    message.bytes.assign(take(length), length);
+    return message;
+}
+
+bool Shard_Message::at_end() const {
+    return cursor == bytes.size();
+}
+
+std::size_t Shard_Message::size() const {
+    return bytes.size();
+}
+
+void Shard_Message::clear() {
+    bytes.clear();
+    cursor = 0;
+}
+
+const char* Shard_Message::take(const std::size_t count) {
+    if (bytes.size() - cursor < count)
+        throw FileException("Error: Region message is truncated");
+    const char* data = bytes.data() + cursor;
+    cursor += count;
+    return data;
+}
+
+Shard_Channel::Shard_Channel(const int _socket) : socket(_socket) {}
+
+Shard_Channel::~Shard_Channel() {
+    close();
+}
+
+Shard_Channel::Shard_Channel(Shard_Channel&& other) noexcept : socket(std::exchange(other.socket, -1)) {}
+
+Shard_Channel& Shard_Channel::operator=(Shard_Channel&& other) noexcept {
+    if (this != &other) {
+        close();
+        socket = std::exchange(other.socket, -1);
+    }
+    return *this;
+}
+
+void Shard_Channel::send(const Shard_Message& message) {
+    const std::uint64_t length = message.bytes.size();
+    write_all(reinterpret_cast<const char*>(&length), sizeof length);
+    write_all(message.bytes.data(), message.bytes.size());
+}
+
+void Shard_Channel::receive(Shard_Message& message) {
+    std::uint64_t length;
+    read_all(reinterpret_cast<char*>(&length), sizeof length);
+    message.bytes.resize(length);
+    message.cursor = 0;
+    read_all(message.bytes.data(), message.bytes.size());
+}
+
+void Shard_Channel::close() {
+    if (socket >= 0)
+        ::close(socket);
+    socket = -1;
+}
+
+// MSG_NOSIGNAL turns a closed peer into an error instead of SIGPIPE.
+void Shard_Channel::write_all(const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t sent = ::send(socket, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0)
+            throw FileException("Error: Region worker connection closed");
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+}
+
+void Shard_Channel::read_all(char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t received = ::recv(socket, data, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0)
+            throw FileException("Error: Region worker connection closed");
+        data += received;
+        size -= static_cast<std::size_t>(received);
+    }
+}
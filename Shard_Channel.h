@@ -0,0 +1,94 @@
+#ifndef SHARD_CHANNEL_H
+#define SHARD_CHANNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "SimulationException.h"
+
+/**
+ * Shard_Request enum
+ * Requests the coordinator of a sharded world sends its region workers, the first byte of every request.
+ */
+enum class Shard_Request : std::uint8_t {
+    Begin_Hour,         // Advance the clock, reply with the vehicles that left the region, by destination.
+    Adopt,              // Take the packed vehicles, empty reply.
+    Step,               // Run one sub-step, reply with the truck reports, the choppers held back and the inventory changes.
+    Release_Orders,     // Reply with the packed vehicles of the given orders, they leave the region.
+    Release_Names,      // Reply with the packed vehicles of the given names, they leave the region.
+    Ghosts,             // Reply with the troopers in police range of the given points.
+    Status,             // Reply with the status text of every vehicle, by order.
+    Marks,              // Reply with the name, type and location of every vehicle, by order.
+    Hash,               // Reply with the deliveries and the hash input of every vehicle, by order.
+    Tick,               // Set the sub-step length, empty reply.
+    Stop                // Exit, no reply.
+};
+
+/**
+ * Shard_Message class
+ * Bytes of one request or reply between the coordinator and a region worker.
+ * Values are written in their native layout, both ends are the same program on the same machine.
+ * Reading past the end throws FileException.
+ */
+class Shard_Message {
+public:
+    template<typename T>
+    void put(const T& value) {                          // Append a plain value.
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain values are copied into a message");
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof value);
+    }
+
+    template<typename T>
+    T get() {                                           // Read the next plain value.
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain values are copied out of a message");
+        T value;
+        std::memcpy(&value, take(sizeof value), sizeof value);
+        return value;
+    }
+
+    void put_text(std::string_view text);               // Append the length, then the characters.
+    std::string get_text();                             // Read text written by put_text.
+    void put_message(const Shard_Message& other);       // Append the size, then every byte of another message.
+    Shard_Message get_message();                        // Read a message written by put_message.
+    bool at_end() const;                                // Everything was read.
+    std::size_t size() const;                           // Bytes written.
+    void clear();                                       // Empty, keep the memory.
+
+private:
+    friend class Shard_Channel;
+    const char* take(std::size_t count);                // Advance the read position, throws past the end.
+
+    std::string bytes;                                  // Message content.
+    std::size_t cursor = 0;                             // Read position.
+};
+
+/**
+ * Shard_Channel class
+ * One end of a Unix stream socket pair between the coordinator and a region worker.
+ * Every message is sent as its length and its bytes, a worker answers one request at a time.
+ * A closed or broken socket throws FileException.
+ */
+class Shard_Channel {
+public:
+    explicit Shard_Channel(int _socket = -1);           // Take an open socket.
+    ~Shard_Channel();                                   // Close the socket.
+    Shard_Channel(Shard_Channel&& other) noexcept;
+    Shard_Channel& operator=(Shard_Channel&& other) noexcept;
+    Shard_Channel(const Shard_Channel&) = delete;
+    Shard_Channel& operator=(const Shard_Channel&) = delete;
+
+    void send(const Shard_Message& message);            // Write a whole message.
+    void receive(Shard_Message& message);               // Replace message by the next one, read from the start.
+    void close();                                       // Close the socket, the other end reads end of file.
+
+private:
+    void write_all(const char* data, std::size_t size); // Write until done.
+    void read_all(char* data, std::size_t size);        // Read until done.
+
+    int socket = -1;                                    // Connected socket.
+};
+
+#endif //SHARD_CHANNEL_H
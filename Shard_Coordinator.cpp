@@ -0,0 +1,460 @@
+#include "Shard_Coordinator.h"
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "SimulationException.h"
+#include "Utils.h"
+
+Map_Mark::Map_Mark(const std::string& name, const Kind kind, const Point& _location)
+    : Sim_Obj(name, kind), location(_location) {}
+
+Point Map_Mark::get_location() const {
+    return location;
+}
+
+void Map_Mark::broadcast_current_state(Status_Text&) const {}
+
+void Map_Mark::update(double) {}
+
+void Map_Mark::hash_state(State_Hash&) const {}
+
+// Every worker builds its world from the scenario the coordinator loaded, no file is parsed again,
+// and keeps the trucks starting in its strip. Output is flushed first so no buffered text is written
+// twice, a worker never returns into the caller. A failing worker prints its error on stderr before it
+// exits, the coordinator then fails to reach it and reports that too.
+Shard_Coordinator::Shard_Coordinator(Model& _model, Region_Map _regions)
+    : model(_model), regions(std::move(_regions)) {
+    std::cout.flush();
+    model.get_output().flush();
+    for (std::size_t region = 0; region < regions.size(); ++region) {
+        int ends[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0)
+            throw FileException("Error: Could not connect a region worker");
+        const pid_t pid = fork();
+        if (pid < 0) {
+            ::close(ends[0]);
+            ::close(ends[1]);
+            throw FileException("Error: Could not start a region worker");
+        }
+        if (pid == 0) {
+            ::close(ends[0]);
+            for (auto& worker : workers)
+                worker.close();
+            int code = 0;
+            try {
+                Model world;
+                world.set_truck_filter([&](const Point& origin) { return regions.region_of(origin) == region; });
+                world.load_scenario(model.get_scenario());
+                world.set_truck_filter(nullptr);
+                Shard_Worker(world, regions, region, Shard_Channel(ends[1])).run();
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Region " << region << " worker stopped: " << e.what() << std::endl;
+                code = 1;
+            } catch (...) {
+                std::cerr << "Error: Region " << region << " worker stopped" << std::endl;
+                code = 1;
+            }
+            _exit(code);
+        }
+        ::close(ends[1]);
+        workers.emplace_back(ends[0]);
+        pids.push_back(pid);
+    }
+}
+
+Shard_Coordinator::~Shard_Coordinator() {
+    Shard_Message stop;
+    stop.put(Shard_Request::Stop);
+    for (auto& worker : workers) {
+        try {
+            worker.send(stop);
+        } catch (const SimulationException&) {}     // The worker is gone already.
+        worker.close();
+    }
+    for (const pid_t pid : pids)
+        waitpid(pid, nullptr, 0);
+}
+
+// Commands that only read the world or change views run as they are.
+void Shard_Coordinator::install(Command_Table& commands) {
+    for (const std::string_view name : {"record", "serve", "feed", "proximity", "archive"})
+        commands.add(name, [](const Tokens&) {
+            throw InvalidCommandException("Error: Command is not available in a world split into regions");
+        });
+
+    commands.add("go", [this](const Tokens& parameters) {
+        if (parameters.size() != 1)
+            throw InvalidCommandFormatException("Error: Go receives 0 arguments");
+        go();
+    });
+
+    const CommandFunction tick = *commands.find("tick");
+    commands.add("tick", [this, tick](const Tokens& parameters) {
+        tick(parameters);
+        Shard_Message request;
+        request.put(Shard_Request::Tick);
+        request.put(model.get_tick_minutes());
+        std::vector<Shard_Message> replies;
+        broadcast(request, replies);
+    });
+
+    commands.add("status", [this](const Tokens& parameters) {
+        const bool all = parameters.size() == 2 && parameters[1] == "--all";
+        if (parameters.size() != 1 && !all)
+            throw InvalidCommandFormatException("Error: Status receives 0 arguments or --all");
+        print_status();
+        if (all)
+            model.broadcast_archive();
+    });
+
+    // Same lines as in a single world, the log is written here since the regions step the vehicles.
+    commands.add("checksum", [this](const Tokens& parameters) {
+        if (parameters.size() == 1) {
+            std::ostringstream line;
+            line << "Checksum at time " << model.get_time() << ": " << std::hex << std::setfill('0')
+                 << std::setw(16) << checksum();
+            model.get_output() << line.str() << std::endl;
+            return;
+        }
+        if (parameters.size() != 2)
+            throw InvalidCommandFormatException("Error: Checksum receives at most 1 argument");
+
+        if (checksum_log.is_open())
+            checksum_log.close();
+        if (parameters[1] == "off")
+            return;
+        checksum_log.open(std::string(parameters[1]));
+        if (!checksum_log.is_open())
+            throw FileException("Error: Could not open file <" + std::string(parameters[1]) + ">");
+        checksum_log << std::hex << std::setfill('0');
+        log_checksum();
+    });
+
+    commands.add("show", [this](const Tokens& parameters) {
+        if (parameters.size() != 1)
+            throw InvalidCommandFormatException("Error: Show receives 0 arguments");
+        show();
+    });
+
+    // Vehicle commands find their vehicles by name, the names are the ones the command reads.
+    using Names = std::function<std::vector<std::string>(const Tokens&)>;
+    const auto wrap = [&](const std::string_view name, const Names& names_of) {
+        const CommandFunction command = *commands.find(name);
+        commands.add(name, [this, command, names_of](const Tokens& parameters) {
+            run_gathered(command, parameters, names_of(parameters));
+        });
+    };
+    const Names first = [](const Tokens& parameters) {
+        return std::vector<std::string>{std::string(parameters[0])};
+    };
+    const Names first_and_third = [](const Tokens& parameters) {
+        std::vector<std::string> names{std::string(parameters[0])};
+        if (parameters.size() > 2)
+            names.emplace_back(parameters[2]);
+        return names;
+    };
+    wrap("course", first);
+    wrap("position", first);
+    wrap("stop", first);
+    wrap("destination", first_and_third);
+    wrap("create", [](const Tokens& parameters) {       // A taken name is found as in a single world.
+        return parameters.size() > 1 ? std::vector<std::string>{std::string(parameters[1])} : std::vector<std::string>();
+    });
+    wrap("create_bulk", [](const Tokens& parameters) {
+        return parameters.size() == 2 ? bulk_names(std::string(parameters[1])) : std::vector<std::string>();
+    });
+
+    // An attack in range happens at once, the troopers near the target are brought in as ghosts.
+    const CommandFunction attack = *commands.find("attack");
+    commands.add("attack", [this, attack, first_and_third](const Tokens& parameters) {
+        run_gathered([this, attack](const Tokens& command) {
+            std::vector<Point> targets;
+            if (command.size() == 3)
+                if (const Truck* truck = model.find_truck_by_name(command[2]))
+                    targets.push_back(truck->get_location());
+            model.set_trooper_ghosts(find_ghosts(targets));
+            try {
+                attack(command);
+            } catch (...) {
+                model.set_trooper_ghosts({});
+                throw;
+            }
+            model.set_trooper_ghosts({});
+        }, parameters, first_and_third(parameters));
+    });
+}
+
+// Every sub-step: the regions step, their truck errors are printed by order and their deliveries added,
+// then the held choppers attack here. The coordinator's own world only holds warehouses by then, its
+// sub-step moves the clock.
+void Shard_Coordinator::go() {
+    model.begin_hour();
+    rebalance();
+    Shard_Message step;
+    step.put(Shard_Request::Step);
+    std::vector<Shard_Message> replies;
+    const int steps = SECONDS_PER_HOUR / (model.get_tick_minutes() * 60);
+    for (int i = 0; i < steps; ++i) {
+        broadcast(step, replies);
+        std::vector<Vehicle_Report> reports;
+        std::vector<std::size_t> choppers, orders;
+        for (auto& reply : replies) {
+            for (auto count = reply.get<std::uint32_t>(); count > 0; --count) {
+                const auto order = reply.get<std::size_t>();
+                reports.push_back({order, reply.get_text()});
+            }
+            for (auto count = reply.get<std::uint32_t>(); count > 0; --count) {
+                choppers.push_back(reply.get<std::size_t>());
+                orders.push_back(choppers.back());
+                for (auto targets = reply.get<std::uint32_t>(); targets > 0; --targets)
+                    orders.push_back(reply.get<std::size_t>());
+            }
+            apply_inventory(reply);
+        }
+        std::stable_sort(reports.begin(), reports.end(),
+                         [](const Vehicle_Report& a, const Vehicle_Report& b) { return a.order < b.order; });
+        for (const auto& entry : reports)
+            model.report(entry.order, entry.text);
+        if (!choppers.empty())
+            attack_held(std::move(choppers), std::move(orders));
+        model.sub_step();
+        log_checksum();
+    }
+}
+
+// Requests go out to every region first, so the regions work on them at the same time.
+void Shard_Coordinator::broadcast(const Shard_Message& request, std::vector<Shard_Message>& replies) {
+    replies.resize(workers.size());
+    for (auto& worker : workers)
+        worker.send(request);
+    for (std::size_t region = 0; region < workers.size(); ++region)
+        workers[region].receive(replies[region]);
+}
+
+void Shard_Coordinator::rebalance() {
+    Shard_Message request;
+    request.put(Shard_Request::Begin_Hour);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    std::vector<std::vector<Shard_Message>> batches(regions.size());
+    for (auto& reply : replies)
+        for (auto count = reply.get<std::uint32_t>(); count > 0; --count) {
+            const auto region = reply.get<std::uint32_t>();
+            batches.at(region).push_back(reply.get_message());
+        }
+    hand_over(batches);
+}
+
+void Shard_Coordinator::hand_over(const std::vector<std::vector<Shard_Message>>& batches) {
+    Shard_Message request, reply;
+    for (std::size_t region = 0; region < batches.size(); ++region) {
+        if (batches[region].empty()) continue;
+        request.clear();
+        request.put(Shard_Request::Adopt);
+        request.put(static_cast<std::uint32_t>(batches[region].size()));
+        for (const auto& batch : batches[region])
+            request.put_message(batch);
+        workers[region].send(request);
+    }
+    for (std::size_t region = 0; region < batches.size(); ++region)
+        if (!batches[region].empty())
+            workers[region].receive(reply);
+}
+
+// The held choppers and their targets come here, then every chopper attacks in registry order
+// with the troopers of all regions near the targets, as the single world would step it.
+void Shard_Coordinator::attack_held(std::vector<std::size_t> choppers, std::vector<std::size_t> orders) {
+    std::sort(choppers.begin(), choppers.end());
+    std::sort(orders.begin(), orders.end());
+    orders.erase(std::unique(orders.begin(), orders.end()), orders.end());
+    Shard_Message request;
+    request.put(Shard_Request::Release_Orders);
+    request.put(static_cast<std::uint32_t>(orders.size()));
+    for (const std::size_t order : orders)
+        request.put(order);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    for (auto& reply : replies)
+        model.adopt(reply);
+
+    std::vector<Point> targets;
+    for (const std::size_t order : orders)
+        if (const Truck* truck = model.find_truck_by_order(order))
+            targets.push_back(truck->get_location());
+    model.set_trooper_ghosts(find_ghosts(targets));
+    for (const auto& obj : model.get_sim_list())
+        if (auto* chopper = sim_cast<Chopper>(obj.get());
+            chopper && std::binary_search(choppers.begin(), choppers.end(), chopper->get_order()))
+            model.step_held(*chopper);
+    model.set_trooper_ghosts({});
+    scatter();
+}
+
+void Shard_Coordinator::gather(const std::vector<std::string>& names) {
+    if (names.empty())
+        return;
+    Shard_Message request;
+    request.put(Shard_Request::Release_Names);
+    request.put(static_cast<std::uint32_t>(names.size()));
+    for (const auto& name : names)
+        request.put_text(name);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    for (auto& reply : replies)
+        model.adopt(reply);
+}
+
+void Shard_Coordinator::scatter() {
+    std::vector<std::vector<Vehicle*>> by_region(regions.size());
+    std::vector<Vehicle*> moved;
+    for (const auto& obj : model.get_sim_list())
+        if (auto* vehicle = sim_cast<Vehicle>(obj.get())) {
+            by_region[regions.region_of(vehicle->get_location())].push_back(vehicle);
+            moved.push_back(vehicle);
+        }
+    if (moved.empty())
+        return;
+    std::vector<std::vector<Shard_Message>> batches(regions.size());
+    for (std::size_t region = 0; region < by_region.size(); ++region) {
+        if (by_region[region].empty()) continue;
+        batches[region].emplace_back();
+        Model::pack_vehicles(by_region[region], batches[region].back());
+    }
+    model.release(moved);
+    hand_over(batches);
+}
+
+// The vehicles go back to their regions even when the command fails.
+void Shard_Coordinator::run_gathered(const CommandFunction& command, const Tokens& parameters,
+                                     const std::vector<std::string>& names) {
+    gather(names);
+    try {
+        command(parameters);
+    } catch (...) {
+        scatter();
+        throw;
+    }
+    scatter();
+}
+
+std::vector<Trooper_Ghost> Shard_Coordinator::find_ghosts(const std::vector<Point>& targets) {
+    std::vector<Trooper_Ghost> ghosts;
+    if (targets.empty())
+        return ghosts;
+    Shard_Message request;
+    request.put(Shard_Request::Ghosts);
+    request.put(static_cast<std::uint32_t>(targets.size()));
+    for (const Point& target : targets)
+        request.put(target);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    for (auto& reply : replies)
+        for (auto count = reply.get<std::uint32_t>(); count > 0; --count) {
+            Trooper_Ghost ghost{};
+            ghost.order = reply.get<std::size_t>();
+            ghost.previous = reply.get<Point>();
+            ghost.location = reply.get<Point>();
+            ghosts.push_back(ghost);
+        }
+    return ghosts;
+}
+
+void Shard_Coordinator::apply_inventory(Shard_Message& reply) {
+    const auto& warehouses = model.get_warehouses();
+    for (auto count = reply.get<std::uint32_t>(); count > 0; --count) {
+        const auto index = reply.get<std::uint32_t>();
+        warehouses.at(index)->update_inventory(reply.get<int>(), true);
+    }
+}
+
+// The coordinator's objects are the warehouses, the vehicles of the regions follow them by order.
+std::uint64_t Shard_Coordinator::checksum() {
+    Shard_Message request;
+    request.put(Shard_Request::Hash);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    int deliveries = 0;
+    std::vector<Vehicle_Hash> vehicles;
+    for (auto& reply : replies) {
+        deliveries += reply.get<int>();
+        for (auto count = reply.get<std::uint64_t>(); count > 0; --count) {
+            Vehicle_Hash vehicle{reply.get<std::size_t>(), {}};
+            vehicle.words.resize(reply.get<std::uint32_t>());
+            for (auto& word : vehicle.words)
+                word = reply.get<std::uint64_t>();
+            vehicles.push_back(std::move(vehicle));
+        }
+    }
+    std::sort(vehicles.begin(), vehicles.end(),
+              [](const Vehicle_Hash& a, const Vehicle_Hash& b) { return a.order < b.order; });
+    return model.checksum(vehicles, deliveries);
+}
+
+void Shard_Coordinator::log_checksum() {
+    if (checksum_log.is_open())
+        checksum_log << std::dec << model.get_time() << " " << model.get_sim_seconds() << " " << std::hex
+                     << std::setw(16) << checksum() << "\n";
+}
+
+// The coordinator's objects are the warehouses, they come first as in a single world.
+void Shard_Coordinator::print_status() {
+    model.broadcast_status();
+    Shard_Message request;
+    request.put(Shard_Request::Status);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    std::vector<std::pair<std::size_t, std::string>> lines;
+    for (auto& reply : replies)
+        for (auto count = reply.get<std::uint64_t>(); count > 0; --count) {
+            const auto order = reply.get<std::size_t>();
+            lines.emplace_back(order, reply.get_text());
+        }
+    std::sort(lines.begin(), lines.end());
+    std::ostream& out = model.get_output();
+    for (const auto& line : lines)
+        out << line.second;
+    out << std::flush;
+}
+
+void Shard_Coordinator::show() {
+    Shard_Message request;
+    request.put(Shard_Request::Marks);
+    std::vector<Shard_Message> replies;
+    broadcast(request, replies);
+    std::vector<std::pair<std::size_t, std::shared_ptr<Sim_Obj>>> marks;
+    for (auto& reply : replies)
+        for (auto count = reply.get<std::uint64_t>(); count > 0; --count) {
+            const auto order = reply.get<std::size_t>();
+            const auto kind = static_cast<Sim_Obj::Kind>(reply.get<std::uint8_t>());
+            const std::string name = reply.get_text();
+            marks.emplace_back(order, std::make_shared<Map_Mark>(name, kind, reply.get<Point>()));
+        }
+    std::sort(marks.begin(), marks.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::list<std::shared_ptr<Sim_Obj>> objects = model.get_sim_list();
+    for (const auto& mark : marks)
+        objects.push_back(mark.second);
+    for (const auto& view : model.get_view_list())
+        view->show(model.get_output(), objects);
+}
+
+// Rows as create_bulk reads them, the name is the first field.
+std::vector<std::string> Shard_Coordinator::bulk_names(const std::string& file_name) {
+    std::vector<std::string> names;
+    std::ifstream file(file_name);
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        const auto tokens = split_line(line);
+        if (!tokens.empty())
+            names.push_back(trim(tokens[0]));
+    }
+    return names;
+}
@@ -0,0 +1,85 @@
+#ifndef SHARD_COORDINATOR_H
+#define SHARD_COORDINATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "Command_Table.h"
+#include "Model.h"
+#include "Shard_Channel.h"
+#include "Shard_Worker.h"
+
+/**
+ * Map_Mark class, extends Sim_Obj
+ * Name, type and location of a vehicle of a region, drawn on the map of a sharded world.
+ */
+class Map_Mark final : public Sim_Obj {
+public:
+    Map_Mark(const std::string& name, Kind kind, const Point& _location);
+    Point get_location() const override;                            // Location when the mark was made.
+    void broadcast_current_state(Status_Text& out) const override;  // Marks have no status.
+    void update(double hours) override;                             // Marks do not move.
+    void hash_state(State_Hash& hash) const override;               // Marks are not world state.
+
+private:
+    Point location;         // Vehicle location.
+};
+
+/**
+ * Shard_Coordinator class
+ * Runs a world split into regions (vertical strips of the map), each one a Shard_Worker process on
+ * this machine, connected by a Unix socket pair. The coordinator keeps the prompt: its Model holds the
+ * warehouses and the clock, a vehicle command first brings the vehicles it names into it from the
+ * regions, runs as in a single world, then sends every vehicle back to the region it is in.
+ *
+ * Every hour the regions hand over the vehicles that left their strip. Trucks, troopers and choppers
+ * without an attack are stepped by their region. A chopper due to attack is held back: it and its
+ * targets are brought to the coordinator and it attacks there, with ghosts of the troopers of every
+ * region near the targets, in registry order. Warehouse deliveries are summed into the coordinator
+ * after every step, truck errors are printed in registry order. The results match a single world.
+ * The checksum gathers the hash input of every vehicle from the regions and mixes it in by order, so it
+ * is the checksum of the same single world.
+ *
+ * Telemetry, snapshots, the shared memory feed, proximity events and archiving need the whole world
+ * in one process, their commands are refused.
+ */
+class Shard_Coordinator {
+public:
+    Shard_Coordinator(Model& _model, Region_Map _regions);  // Start a worker per region on the loaded scenario.
+    Shard_Coordinator(const Shard_Coordinator&) = delete;
+    Shard_Coordinator& operator=(const Shard_Coordinator&) = delete;
+    ~Shard_Coordinator();                       // Stop the workers and wait for them.
+
+    void install(Command_Table& commands);      // Replace the commands that need the whole world.
+    void go();                                  // Advance every region by one hour.
+
+private:
+    void broadcast(const Shard_Message& request, std::vector<Shard_Message>& replies);  // Ask every region.
+    void rebalance();                           // Move vehicles into the region they are in.
+    void hand_over(const std::vector<std::vector<Shard_Message>>& batches);  // Packed vehicles to their regions.
+    void attack_held(std::vector<std::size_t> choppers, std::vector<std::size_t> orders);  // Held choppers attack.
+    void gather(const std::vector<std::string>& names);     // Bring the vehicles of the names here.
+    void scatter();                             // Send every vehicle here to its region.
+    void run_gathered(const CommandFunction& command, const Tokens& parameters,
+                      const std::vector<std::string>& names);  // Gather, run a command, scatter.
+    std::vector<Trooper_Ghost> find_ghosts(const std::vector<Point>& targets);  // Troopers of all regions near targets.
+    void apply_inventory(Shard_Message& reply); // Add the deliveries of a region's step to the warehouses.
+    std::uint64_t checksum();                   // Checksum of the whole world, gathered from the regions.
+    void log_checksum();                        // Append the current checksum to the log, if open.
+    void print_status();                        // Warehouses, then every vehicle by order.
+    void show();                                // Map of the warehouses and every vehicle.
+    static std::vector<std::string> bulk_names(const std::string& file_name);  // Names of a create_bulk file.
+
+    Model& model;                               // Warehouses, clock and the vehicles of the current command.
+    Region_Map regions;                         // Strips of the regions.
+    std::vector<Shard_Channel> workers;         // Connection to every region, by region.
+    std::vector<pid_t> pids;                    // Worker processes, by region.
+    std::ofstream checksum_log;                 // Checksum after every step, when open.
+};
+
+#endif //SHARD_COORDINATOR_H
@@ -0,0 +1,228 @@
+#include "Shard_Worker.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include "Output_Sink.h"
+
+// With fewer values than regions the last strips are empty until vehicles move into them.
+Region_Map::Region_Map(std::vector<double> xs, const std::size_t regions) {
+    std::sort(xs.begin(), xs.end());
+    for (std::size_t i = 1; i < regions; ++i)
+        bounds.push_back(xs.empty() ? 0.0 : xs[std::min(xs.size() - 1, i * xs.size() / regions)]);
+}
+
+std::size_t Region_Map::region_of(const Point& location) const {
+    return static_cast<std::size_t>(std::upper_bound(bounds.begin(), bounds.end(), location.x) - bounds.begin());
+}
+
+std::size_t Region_Map::size() const {
+    return bounds.size() + 1;
+}
+
+// The inventory already loaded is the base the changes are reported against.
+Shard_Worker::Shard_Worker(Model& _world, const Region_Map& _regions, const std::size_t _region, Shard_Channel _channel)
+    : world(_world), regions(_regions), region(_region), channel(std::move(_channel)) {
+    world.set_sink(std::make_unique<Null_Sink>());
+    world.keep_reports(&reports);
+    for (const Warehouse* warehouse : world.get_warehouses())
+        reported.push_back(warehouse->get_inventory());
+}
+
+void Shard_Worker::run() {
+    Shard_Message request, reply;
+    while (true) {
+        channel.receive(request);
+        reply.clear();
+        switch (request.get<Shard_Request>()) {
+            case Shard_Request::Begin_Hour: begin_hour(reply); break;
+            case Shard_Request::Adopt: adopt(request); break;
+            case Shard_Request::Step: step(reply); break;
+            case Shard_Request::Release_Orders: release_orders(request, reply); break;
+            case Shard_Request::Release_Names: release_names(request, reply); break;
+            case Shard_Request::Ghosts: ghosts(request, reply); break;
+            case Shard_Request::Status: status(reply); break;
+            case Shard_Request::Marks: marks(reply); break;
+            case Shard_Request::Hash: hash(reply); break;
+            case Shard_Request::Tick: world.set_tick_minutes(request.get<int>()); break;
+            case Shard_Request::Stop: return;
+        }
+        channel.send(reply);
+    }
+}
+
+// Reply: the number of batches, then every batch as its region and the packed vehicles, by order.
+void Shard_Worker::begin_hour(Shard_Message& reply) {
+    world.begin_hour();
+    std::vector<std::vector<Vehicle*>> leaving(regions.size());
+    for (const auto& obj : world.get_sim_list())
+        if (auto* vehicle = sim_cast<Vehicle>(obj.get())) {
+            const std::size_t target = regions.region_of(vehicle->get_location());
+            if (target != region)
+                leaving[target].push_back(vehicle);
+        }
+
+    std::vector<Vehicle*> moved;
+    std::uint32_t batches = 0;
+    for (const auto& batch : leaving)
+        batches += !batch.empty();
+    reply.put(batches);
+    for (std::size_t target = 0; target < leaving.size(); ++target) {
+        if (leaving[target].empty()) continue;
+        Shard_Message batch;
+        Model::pack_vehicles(leaving[target], batch);
+        reply.put(static_cast<std::uint32_t>(target));
+        reply.put_message(batch);
+        moved.insert(moved.end(), leaving[target].begin(), leaving[target].end());
+    }
+    world.release(moved);
+}
+
+void Shard_Worker::adopt(Shard_Message& request) {
+    for (auto batches = request.get<std::uint32_t>(); batches > 0; --batches) {
+        Shard_Message batch = request.get_message();
+        world.adopt(batch);
+    }
+}
+
+// Reply: the reports as order and text, then every held chopper as its order and the orders of its due targets,
+// then the inventory changes, so the coordinator's warehouses are current after every step.
+void Shard_Worker::step(Shard_Message& reply) {
+    reports.clear();
+    held.clear();
+    world.sub_step(&held);
+    reply.put(static_cast<std::uint32_t>(reports.size()));
+    for (const auto& entry : reports) {
+        reply.put(entry.order);
+        reply.put_text(entry.text);
+    }
+    reply.put(static_cast<std::uint32_t>(held.size()));
+    for (const Chopper* chopper : held) {
+        reply.put(chopper->get_order());
+        std::vector<std::size_t> targets;
+        for (const auto& attack_obj : chopper->get_attack_queue())
+            if (attack_obj.tick == world.get_time())
+                targets.push_back(attack_obj.order);
+        reply.put(static_cast<std::uint32_t>(targets.size()));
+        for (const std::size_t order : targets)
+            reply.put(order);
+    }
+    inventory(reply);
+}
+
+// Held choppers are looked up among the held ones, targets among the trucks.
+void Shard_Worker::release_orders(Shard_Message& request, Shard_Message& reply) {
+    std::vector<Vehicle*> moved;
+    for (auto count = request.get<std::uint32_t>(); count > 0; --count) {
+        const auto order = request.get<std::size_t>();
+        const auto chopper = std::find_if(held.begin(), held.end(),
+                                          [&](const Chopper* candidate) { return candidate->get_order() == order; });
+        if (chopper != held.end())
+            moved.push_back(*chopper);
+        else if (Truck* truck = world.find_truck_by_order(order))
+            moved.push_back(truck);
+    }
+    held.clear();
+    std::sort(moved.begin(), moved.end(), [](const Vehicle* a, const Vehicle* b) { return a->get_order() < b->get_order(); });
+    release(moved, reply);
+}
+
+// Every vehicle of a name is released, a command finds the first one by order as in a single world.
+void Shard_Worker::release_names(Shard_Message& request, Shard_Message& reply) {
+    std::unordered_set<std::string> names;
+    for (auto count = request.get<std::uint32_t>(); count > 0; --count)
+        names.insert(request.get_text());
+    std::vector<Vehicle*> moved;
+    for (const auto& obj : world.get_sim_list())
+        if (auto* vehicle = sim_cast<Vehicle>(obj.get()); vehicle && names.count(vehicle->get_name()))
+            moved.push_back(vehicle);
+    release(moved, reply);
+}
+
+// Reply: the number of troopers found, then each as its order, previous and current location.
+void Shard_Worker::ghosts(Shard_Message& request, Shard_Message& reply) const {
+    std::vector<Trooper_Ghost> found;
+    for (auto count = request.get<std::uint32_t>(); count > 0; --count)
+        world.find_troopers_near(request.get<Point>(), found);
+    reply.put(static_cast<std::uint32_t>(found.size()));
+    for (const auto& ghost : found) {
+        reply.put(ghost.order);
+        reply.put(ghost.previous);
+        reply.put(ghost.location);
+    }
+}
+
+// Reply: the number of changed warehouses, then each as its index and the change.
+void Shard_Worker::inventory(Shard_Message& reply) {
+    const auto& warehouses = world.get_warehouses();
+    std::vector<std::pair<std::uint32_t, int>> changes;
+    for (std::size_t i = 0; i < warehouses.size(); ++i) {
+        const int inventory = warehouses[i]->get_inventory();
+        if (inventory != reported[i])
+            changes.emplace_back(static_cast<std::uint32_t>(i), inventory - reported[i]);
+        reported[i] = inventory;
+    }
+    reply.put(static_cast<std::uint32_t>(changes.size()));
+    for (const auto& [index, change] : changes) {
+        reply.put(index);
+        reply.put(change);
+    }
+}
+
+// Reply: the number of vehicles, then each as its order and status text, by order.
+void Shard_Worker::status(Shard_Message& reply) const {
+    std::vector<const Vehicle*> listed;
+    for (const auto& obj : world.get_sim_list())
+        if (const auto* vehicle = sim_cast<Vehicle>(obj.get()))
+            listed.push_back(vehicle);
+    reply.put(static_cast<std::uint64_t>(listed.size()));
+    Status_Text text;
+    for (const Vehicle* vehicle : listed) {
+        text.clear();
+        vehicle->broadcast_current_state(text);
+        reply.put(vehicle->get_order());
+        reply.put_text(text.str());
+    }
+}
+
+// Reply: the number of vehicles, then each as its order, type, name and location, by order.
+void Shard_Worker::marks(Shard_Message& reply) const {
+    std::vector<const Vehicle*> listed;
+    for (const auto& obj : world.get_sim_list())
+        if (const auto* vehicle = sim_cast<Vehicle>(obj.get()))
+            listed.push_back(vehicle);
+    reply.put(static_cast<std::uint64_t>(listed.size()));
+    for (const Vehicle* vehicle : listed) {
+        reply.put(vehicle->get_order());
+        reply.put(static_cast<std::uint8_t>(vehicle->get_kind()));
+        reply.put_text(vehicle->get_name());
+        reply.put(vehicle->get_location());
+    }
+}
+
+// Reply: the deliveries of the region, the number of vehicles, then each as its order and the words its
+// hash_state feeds, by order.
+void Shard_Worker::hash(Shard_Message& reply) const {
+    reply.put(world.get_deliveries());
+    std::vector<const Vehicle*> listed;
+    for (const auto& obj : world.get_sim_list())
+        if (const auto* vehicle = sim_cast<Vehicle>(obj.get()))
+            listed.push_back(vehicle);
+    reply.put(static_cast<std::uint64_t>(listed.size()));
+    std::vector<std::uint64_t> words;
+    for (const Vehicle* vehicle : listed) {
+        words.clear();
+        State_Hash state(&words);
+        vehicle->hash_state(state);
+        reply.put(vehicle->get_order());
+        reply.put(static_cast<std::uint32_t>(words.size()));
+        for (const std::uint64_t word : words)
+            reply.put(word);
+    }
+}
+
+void Shard_Worker::release(const std::vector<Vehicle*>& moved, Shard_Message& reply) {
+    Model::pack_vehicles(moved, reply);
+    world.release(moved);
+}
@@ -0,0 +1,58 @@
+#ifndef SHARD_WORKER_H
+#define SHARD_WORKER_H
+
+#include <cstddef>
+#include <vector>
+#include "Geometry.h"
+#include "Model.h"
+#include "Shard_Channel.h"
+
+/**
+ * Region_Map class
+ * Splits the map into vertical strips, one region each. The strip bounds are quantiles of the
+ * given x values (truck origins), so every region starts with about the same share of the trucks.
+ */
+class Region_Map {
+public:
+    Region_Map(std::vector<double> xs, std::size_t regions);    // Strips holding equal shares of xs.
+    std::size_t region_of(const Point& location) const;        // Strip of a location.
+    std::size_t size() const;                                   // Number of regions.
+
+private:
+    std::vector<double> bounds;     // Lowest x of every strip after the first, ascending.
+};
+
+/**
+ * Shard_Worker class
+ * A region of a sharded world, run in its own process. Holds the vehicles inside its strip in a Model
+ * of its own (every warehouse, only those vehicles) and answers the Shard_Request of the coordinator
+ * one at a time until Stop. Output of the world is dropped, truck errors are sent to the coordinator.
+ */
+class Shard_Worker {
+public:
+    Shard_Worker(Model& _world, const Region_Map& _regions, std::size_t _region, Shard_Channel _channel);
+    void run();                                     // Answer requests until Stop.
+
+private:
+    void begin_hour(Shard_Message& reply);          // Advance the clock, pack the vehicles that left the strip.
+    void adopt(Shard_Message& request);             // Take vehicles of other regions.
+    void step(Shard_Message& reply);                // One sub-step, reports and held choppers.
+    void release_orders(Shard_Message& request, Shard_Message& reply);  // Pack vehicles by order.
+    void release_names(Shard_Message& request, Shard_Message& reply);   // Pack vehicles by name.
+    void ghosts(Shard_Message& request, Shard_Message& reply) const;    // Troopers near points.
+    void inventory(Shard_Message& reply);           // Warehouse changes since the last step.
+    void status(Shard_Message& reply) const;        // Status text of every vehicle.
+    void marks(Shard_Message& reply) const;         // Map mark of every vehicle.
+    void hash(Shard_Message& reply) const;          // Deliveries and hash input of every vehicle.
+    void release(const std::vector<Vehicle*>& moved, Shard_Message& reply);   // Pack, then remove from the world.
+
+    Model& world;                                   // Vehicles of the region.
+    const Region_Map& regions;                      // Strips of all regions.
+    std::size_t region;                             // Strip of this worker.
+    Shard_Channel channel;                          // Connection to the coordinator.
+    std::vector<Vehicle_Report> reports;            // Truck errors of the current step.
+    std::vector<Chopper*> held;                     // Choppers held back in the current step.
+    std::vector<int> reported;                      // Warehouse inventory last sent, by index.
+};
+
+#endif //SHARD_WORKER_H
@@ -1,7 +1,19 @@
 #include "Sim_Obj.h"
 
-Sim_Obj::Sim_Obj(std::string  _name): name(std::move(_name)){}
+Sim_Obj::Sim_Obj(std::string  _name, const Kind _kind): name(std::move(_name)), kind(_kind){}
 
-std::string Sim_Obj::get_name() const {
+const std::string& Sim_Obj::get_name() const {
     return name;
-}
\ No newline at end of file
+}
+
+Sim_Obj::Kind Sim_Obj::get_kind() const {
+    return kind;
+}
+
+Handle Sim_Obj::get_handle() const {
+    return handle;
+}
+
+void Sim_Obj::set_handle(const Handle _handle) {
+    handle = _handle;
+}
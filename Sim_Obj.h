@@ -1,25 +1,49 @@
 #ifndef SIMULATION_OBJECT_H
 #define SIMULATION_OBJECT_H
 
+#include <cstdint>
 #include <string>
 #include "Geometry.h"
+#include "State_Hash.h"
+#include "Status_Text.h"
+
+/**
+ * Handle struct
+ * Reference to a simulation object by slot index and generation, see Handle_Table.
+ * The generation changes when the slot is reused, so a handle to a removed object never resolves to another one.
+ */
+struct Handle {
+    std::uint32_t index = 0;            // Slot in the Model's handle table.
+    std::uint32_t generation = 0;       // Slot generation when the handle was made, 0 is the null handle.
+
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
 
 /**
  * Sim_Obj class
  * Abstract base class for all simulation objects.
  * Provides common interface: name, broadcasting, location retrieval, and update mechanism.
+ * The set of object types is closed, every object carries its type tag so code can branch on it without RTTI.
  */
 class Sim_Obj{
 public:
-    explicit Sim_Obj(std::string _name);                // Constructor.
-    std::string get_name() const;                       // Get object name.
-    virtual void broadcast_current_state() const = 0;   // Broadcast state (pure virtual).
+    enum Kind {Warehouse_Kind, Truck_Kind, Chopper_Kind, Trooper_Kind};  // All concrete object types.
+    Sim_Obj(std::string _name, Kind _kind);             // Constructor.
+    const std::string& get_name() const;                // Get object name.
+    Kind get_kind() const;                              // Get the concrete object type.
+    Handle get_handle() const;                          // Get the handle other objects refer to this one by.
+    void set_handle(Handle _handle);                    // Set by the Model when the object is registered.
+    virtual void broadcast_current_state(Status_Text& out) const = 0;  // Broadcast state (pure virtual).
     virtual Point get_location() const = 0;             // Get location (pure virtual).
-    virtual void update() = 0;                          // Update state (pure virtual).
+    virtual void update(double hours) = 0;              // Update state over a time step of given hours (pure virtual).
+    virtual void hash_state(State_Hash& hash) const = 0;    // Mix all simulation state into a checksum (pure virtual).
     virtual ~Sim_Obj() = default;                       // Virtual destructor.
 
 private:
     std::string name;                                   // Object name.
+    Kind kind;                                          // Concrete object type.
+    Handle handle;                                      // Handle in the Model, null until registered.
 };
 
 #endif //SIMULATION_OBJECT_H
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef SIM_TYPES_H
+#define SIM_TYPES_H
+
+#include <type_traits>
+#include <variant>
+#include "Sim_Obj.h"
+
+class Vehicle;
+class Truck;
+class Chopper;
+class StateTrooper;
+
+/**
+ * Closed list of the vehicle types.
+ * Vehicle_Ref holds a vehicle as its final type, so std::visit resolves every call at compile time
+ * and the compiler can inline it, sim_cast replaces dynamic_cast by a check of the object's type tag.
+ */
+using Vehicle_Ref = std::variant<Truck*, Chopper*, StateTrooper*>;
+
+template<typename T>
+bool is_kind(const Sim_Obj::Kind kind) {                   // Is an object of this type tag a T?
+    if constexpr (std::is_same_v<T, Sim_Obj>)
+        return true;
+    else if constexpr (std::is_same_v<T, Vehicle>)
+        return kind != Sim_Obj::Warehouse_Kind;
+    else
+        return kind == T::KIND;
+}
+
+template<typename T, typename From>
+auto sim_cast(From* obj) {                                 // Downcast by type tag, null if obj is not a T.
+    using Target = std::conditional_t<std::is_const_v<From>, const T, T>;
+    return obj && is_kind<T>(obj->get_kind()) ? static_cast<Target*>(obj) : nullptr;
+}
+
+#endif //SIM_TYPES_H
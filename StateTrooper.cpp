@@ -1,12 +1,27 @@
 #include "StateTrooper.h"
-#include <iomanip>
 #include <iostream>
-#include <limits>
 #include "Model.h"
-
-StateTrooper::StateTrooper(const std::string &name, const Point& pos, std::string  starting_warehouse)
-    : Vehicle(name, 90.0, 0, pos), origin_warehouse_name(std::move(starting_warehouse)) {
-    visited_warehouses.emplace(starting_warehouse);
+#include "Shard_Channel.h"
+
+// The origin is marked as visited on the first return to it, which also starts the shared patrol tour.
+StateTrooper::StateTrooper(Model& model, const std::string &name, const Point& pos, std::string  starting_warehouse)
+    : Vehicle(model, name, KIND, 90.0, 0, pos),
+      visited(model.get_warehouses().size(), false),
+      origin_index(model.find_warehouse_by_name(starting_warehouse)->get_index()) {}
+
+// Warehouses are packed by index, the tour is the shared one of the origin in this world.
+StateTrooper::StateTrooper(Model& model, Shard_Message& message)
+    : Vehicle(model, KIND, message), destination_point(message.get<Point>()) {
+    const auto destination = message.get<std::uint64_t>();
+    destination_warehouse = destination ? model.get_warehouses().at(destination - 1) : nullptr;
+    has_destination = message.get<bool>();
+    visited.resize(message.get<std::uint64_t>());
+    for (std::size_t i = 0; i < visited.size(); ++i)
+        visited[i] = message.get<bool>();
+    origin_index = message.get<std::size_t>();
+    if (message.get<bool>())
+        tour = model.get_patrol_tour(origin_index);
+    tour_position = message.get<std::size_t>();
 }
 
 void StateTrooper::set_parameters(const double speed, const double course) {
@@ -15,11 +30,12 @@ void StateTrooper::set_parameters(const double speed, const double course) {
 }
 
 void StateTrooper::set_destination(const std::string &warehouse_name) {
-    const Warehouse* dest = Model::get_instance().find_warehouse_by_name(warehouse_name);
+    const Warehouse* dest = get_model().find_warehouse_by_name(warehouse_name);
     if (!dest)
         throw std::invalid_argument("Error: Warehouse not found");
 
     destination_point = dest->get_location();
+    destination_warehouse = dest;
     set_course(calculate_course_deg(get_location(), destination_point));
     set_speed(90.0);
     set_status(MovingTo);
@@ -30,52 +46,56 @@ void StateTrooper::set_position(Point &pos) {
     const double course = calculate_course_deg(pos, destination_point);
     Vehicle::set_course(course);
     destination_point = pos;
+    destination_warehouse = get_model().find_warehouse_at(pos);
+    tour.reset();
     set_status(MovingTo);
     has_destination = true;
 }
 
+// Any course change by command takes the trooper off its patrol tour.
 void StateTrooper::set_course(const double course) {
     if (course >= 0 && course <= 360) {
         Vehicle::set_course(course);
         set_status(MovingOnCourse);
+        tour.reset();
     }
 }
 
-void StateTrooper::broadcast_current_state() const {
-    const std::string warehouse_name = Model::get_instance().get_warehouse_name_from_point(destination_point);
-    std::string dest;
-
-    if (!warehouse_name.empty())
-        dest = warehouse_name;
-    else {
-        std::ostringstream oss;
-        oss << "(" << std::fixed << std::setprecision(2)
-            << destination_point.x << ", " << destination_point.y << ")";
-        dest = oss.str();
-    }
-
-    std::cout << "State_trooper " << get_name() << " at ";
-    get_location().print();
+void StateTrooper::broadcast_current_state(Status_Text& out) const {
+    out << "State_trooper " << get_name() << " at " << get_location();
     switch (get_status()) {
         case Stopped:
-            std::cout << ", Stopped" << std::endl;
+            out << ", Stopped" << '\n';
             break;
         case MovingTo:
-            std::cout << ", " << get_status_string() << " " << dest
-                      << ", speed " << get_speed() << " km/h" << std::endl;
+            out << ", " << get_status_string() << " ";
+            if (destination_warehouse && !destination_warehouse->get_name().empty())
+                out << destination_warehouse->get_name();
+            else
+                out << destination_point;
+            out << ", speed " << get_speed() << " km/h" << '\n';
             break;
         default:
             break;
     }
 }
 
-void StateTrooper::update() {
-    if (get_status() == Stopped || !has_destination)    // if a trooper is stopped or doesn't have a destination return.
-        return;
+bool StateTrooper::begin_step() {
+    // if a trooper is stopped or doesn't have a destination it stays.
+    const bool moving = get_status() != Stopped && has_destination;
+    set_moving(moving);
+    return moving;
+}
 
-    const Point prev = get_location();
+bool StateTrooper::is_dormant() const {
+    return get_status() == Stopped || !has_destination;
+}
 
-    Vehicle::update();
+void StateTrooper::end_step() {
+    if (!is_moving())
+        return;
+
+    const Point prev = get_previous_location();
 
     // if trooper didnt pass destination, return.
     if (!has_passed_target(prev, destination_point, get_location()))
@@ -85,45 +105,73 @@ void StateTrooper::update() {
     Vehicle::set_position(destination_point);
     has_destination = false;
 
-    // Check what warehouse trooper arrived to and insert him into the set.
-    const std::string arrived_name = Model::get_instance().get_warehouse_name_from_point(destination_point);
-    if (!arrived_name.empty())
-        visited_warehouses.insert(arrived_name);
-
-    // Full warehouse rotation finished, start another one.
-    if (arrived_name == origin_warehouse_name) {
-        visited_warehouses.clear();
-        visited_warehouses.insert(origin_warehouse_name);
+    // Mark the warehouse the trooper arrived to, a tour stop moves the tour forward.
+    Model& model = get_model();
+    const Warehouse* arrived = destination_warehouse;
+    visited.resize(model.get_warehouses().size(), false);
+    if (arrived) {
+        visited[arrived->get_index()] = true;
+        if (tour) ++tour_position;
     }
 
-    const auto& sim_objs = Model::get_instance().get_sim_list();
-    Warehouse* next = nullptr;
-    double min_dist = numeric_limits<double>::max();
-
-    // Find the next closest warehouse that was unvisited.
-    for (const auto& obj : sim_objs) {
-        auto warehouse = std::dynamic_pointer_cast<Warehouse>(obj);
-        if (!warehouse) continue;
-
-        const std::string warehouse_name = warehouse->get_name();
-
-        // Skip already visited
-        if (visited_warehouses.count(warehouse_name)) continue;
+    // Full warehouse rotation finished, start another one on the shared tour of the origin.
+    if (arrived && arrived->get_index() == origin_index) {
+        visited.assign(visited.size(), false);
+        visited[origin_index] = true;
+        tour = model.get_patrol_tour(origin_index);
+        tour_position = 0;
+    }
 
-        const double dist = calculate_distance(get_location(), warehouse->get_location());
+    // On the tour the next stop is known, otherwise find the closest unvisited warehouse.
+    Warehouse* next;
+    if (tour)
+        next = tour_position < tour->size() ? model.get_warehouses()[(*tour)[tour_position]] : nullptr;
+    else
+        next = model.find_nearest_unvisited(get_location(), arrived, visited);
 
-        if (dist < min_dist || (abs(dist - min_dist) < 1e-6 && warehouse_name < next->get_name())) {
-            min_dist = dist;
-            next = warehouse.get();
-        }
-    }
     // The next destination found, go to the next warehouse.
     if (next) {
         destination_point = next->get_location();
+        destination_warehouse = next;
         has_destination = true;
-        const double angle = calculate_course_deg(get_location(), destination_point);
-        set_course(angle);
+        const double angle = arrived ? model.get_course(*arrived, *next)
+                                     : calculate_course_deg(get_location(), destination_point);
+        Vehicle::set_course(angle);
         set_speed(90.0);
         set_status(MovingTo);
     }
-}
\ No newline at end of file
+}
+
+// Visited warehouses are packed 64 to a word.
+void StateTrooper::hash_state(State_Hash& hash) const {
+    Vehicle::hash_state(hash);
+    hash.add(has_destination);
+    hash.add(destination_point.x);
+    hash.add(destination_point.y);
+    hash.add(static_cast<std::uint64_t>(destination_warehouse ? destination_warehouse->get_index() + 1 : 0));
+    hash.add(static_cast<std::uint64_t>(visited.size()));
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < visited.size(); ++i) {
+        word |= static_cast<std::uint64_t>(visited[i]) << (i % 64);
+        if (i % 64 == 63) {
+            hash.add(word);
+            word = 0;
+        }
+    }
+    hash.add(word);
+    hash.add(tour != nullptr);
+    hash.add(static_cast<std::uint64_t>(tour_position));
+}
+
+void StateTrooper::pack(Shard_Message& message) const {
+    Vehicle::pack(message);
+    message.put(destination_point);
+    message.put(static_cast<std::uint64_t>(destination_warehouse ? destination_warehouse->get_index() + 1 : 0));
+    message.put(has_destination);
+    message.put(static_cast<std::uint64_t>(visited.size()));
+    for (const bool flag : visited)
+        message.put(flag);
+    message.put(origin_index);
+    message.put(tour != nullptr);
+    message.put(tour_position);
+}
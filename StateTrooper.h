@@ -1,31 +1,46 @@
 #ifndef STATETROOPER_H
 #define STATETROOPER_H
 
-#include <set>
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include "Vehicle.h"
 
+class Warehouse;
+
 /**
  * StateTrooper class, extends Vehicle
  * Represents a state trooper that moves between warehouses and tracks visited ones.
+ * After returning to its origin the trooper follows the patrol tour of that origin, shared by all
+ * troopers starting there, and only falls back to a nearest-warehouse search when a command moved it off the tour.
  * Overrides base Vehicle functions to provide trooper-specific behavior.
  */
 class StateTrooper final : public Vehicle{
 public:
-    StateTrooper(const std::string &name, const Point& pos, std::string starting_warehouse); // Constructor.
+    static constexpr Kind KIND = Trooper_Kind;
+    StateTrooper(Model& model, const std::string &name, const Point& pos, std::string starting_warehouse); // Constructor.
+    StateTrooper(Model& model, Shard_Message& message);              // Unpack a trooper packed by another world.
 
     void set_destination(const std::string &warehouse_name) override; // Set destination warehouse.
     void set_parameters(double speed, double course) override;        // Set speed and course.
     void set_course(double course) override;                          // Set course.
     void set_position(Point &pos) override;                           // Set position.
-    void broadcast_current_state() const override;                    // Broadcast state.
+    void broadcast_current_state(Status_Text& out) const override;                    // Broadcast state.
 
-    void update() override;                                           // Update trooper state.
+    bool begin_step() override;                                       // Moves only towards a destination.
+    void end_step() override;                                         // Arrival and next warehouse selection.
+    bool is_dormant() const;                                          // Stopped, or no destination.
+    void hash_state(State_Hash& hash) const override;                 // Adds destination, visited and tour state.
+    void pack(Shard_Message& message) const override;                 // Adds destination, visited and tour state.
 
 private:
-    Point destination_point;             // Current destination point.
-    bool has_destination = false;        // Flag indicating if destination is set.
-    set<std::string> visited_warehouses; // Set of warehouses visited.
-    std::string origin_warehouse_name;   // Starting warehouse name.
+    Point destination_point;                     // Current destination point.
+    const Warehouse* destination_warehouse = nullptr;  // Warehouse at the destination point, if any.
+    bool has_destination = false;                // Flag indicating if destination is set.
+    std::vector<bool> visited;                   // Visited warehouses, indexed by warehouse index.
+    std::size_t origin_index;                    // Starting warehouse index.
+    std::shared_ptr<const std::vector<std::size_t>> tour;  // Patrol tour of the origin, null when off the tour.
+    std::size_t tour_position = 0;               // Index of the next tour stop.
 };
 
 #endif //STATETROOPER_H
\ No newline at end of file
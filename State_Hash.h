@@ -0,0 +1,59 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+/**
+ * State_Hash class
+ * Stable 64 bit hash of simulation state, fed word by word in one pass.
+ * Doubles are hashed by their bit pattern, so two worlds only match if every value is bit-identical.
+ * The words fed can also be kept, so another process mixes them in at their place of the world.
+ */
+class State_Hash {
+public:
+    State_Hash() = default;
+    explicit State_Hash(std::vector<std::uint64_t>* _words) : words(_words) {}  // Also keep every word fed.
+
+    void add(const std::uint64_t value) {               // Mix in one word.
+        if (words)
+            words->push_back(value);
+        state = (state ^ value) * 0x100000001b3ull;
+        state ^= state >> 29;
+    }
+    void add(const std::int64_t value) { add(static_cast<std::uint64_t>(value)); }
+    void add(const int value) { add(static_cast<std::uint64_t>(static_cast<std::int64_t>(value))); }
+    void add(const bool value) { add(static_cast<std::uint64_t>(value)); }
+    void add(const double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        add(bits);
+    }
+    void add(const std::string_view text) {             // Length, then 8 bytes at a time.
+        add(static_cast<std::uint64_t>(text.size()));
+        std::size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, text.data() + i, sizeof word);
+            add(word);
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, text.data() + i, text.size() - i);
+        add(tail);
+    }
+
+    std::uint64_t value() const {                       // Final avalanche (splitmix64).
+        std::uint64_t z = state + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state = 0xcbf29ce484222325ull;        // FNV offset basis.
+    std::vector<std::uint64_t>* words = nullptr;        // Words fed, when kept.
+};
+
+#endif //STATE_HASH_H
@@ -0,0 +1,56 @@
+#ifndef STATUS_TEXT_H
+#define STATUS_TEXT_H
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Geometry.h"
+
+#define STATUS_NUMBER_LENGTH 320                // Longest formatted number, a fixed double has up to 309 digits.
+
+/**
+ * Status_Text class
+ * Growing text buffer status lines are formatted into. Numbers are written with std::to_chars,
+ * doubles with two decimals, the same text a fixed / precision 2 stream prints, without locale or stream state.
+ * Every thread formats into its own Status_Text.
+ */
+class Status_Text {
+public:
+    Status_Text& operator<<(const std::string_view s) {     // Append text.
+        text.append(s);
+        return *this;
+    }
+
+    Status_Text& operator<<(const char c) {                 // Append a character.
+        text.push_back(c);
+        return *this;
+    }
+
+    Status_Text& operator<<(const int value) {              // Append a whole number.
+        char digits[STATUS_NUMBER_LENGTH];
+        const auto result = std::to_chars(digits, digits + sizeof digits, value);
+        text.append(digits, result.ptr);
+        return *this;
+    }
+
+    Status_Text& operator<<(const double value) {           // Append with two decimals.
+        char digits[STATUS_NUMBER_LENGTH];
+        const auto result = std::to_chars(digits, digits + sizeof digits, value, std::chars_format::fixed, 2);
+        text.append(digits, result.ptr);
+        return *this;
+    }
+
+    Status_Text& operator<<(const Point& point) {           // Append as (x, y).
+        return *this << '(' << point.x << ", " << point.y << ')';
+    }
+
+    const std::string& str() const { return text; }        // Text so far.
+    std::size_t size() const { return text.size(); }       // Length of the text.
+    void clear() { text.clear(); }                          // Empty the text, keep the memory.
+
+private:
+    std::string text;
+};
+
+#endif //STATUS_TEXT_H
@@ -0,0 +1,108 @@
+#include "Sweep.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include "Controller.h"
+#include "SimulationException.h"
+
+Sweep::Sweep(const Scenario& _base) : base(_base) {}
+
+void Sweep::load(const std::string& file_name) {
+    std::ifstream file(file_name);
+    if (!file.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        // Name and hours are the first two fields, the rest are commands (coordinates contain commas).
+        const size_t first = line.find(',');
+        const size_t second = first == std::string::npos ? first : line.find(',', first + 1);
+        if (second == std::string::npos)
+            throw InvalidInputLineException("Error: Sweep line " + std::to_string(line_number) +
+                                            " must be <name>, <hours>, <commands>");
+
+        Variant variant;
+        variant.name = trim(line.substr(0, first));
+        const std::string hours = trim(line.substr(first + 1, second - first - 1));
+        if (variant.name.empty() || !is_number(hours) || hours.find('.') != std::string::npos || hours[0] == '-')
+            throw InvalidInputLineException("Error: Sweep line " + std::to_string(line_number) +
+                                            " has a bad name or hours");
+        variant.hours = std::stoi(hours);
+
+        std::istringstream commands(line.substr(second + 1));
+        std::string command;
+        while (std::getline(commands, command, ';')) {
+            command = trim(command);
+            if (!command.empty())
+                variant.commands.push_back(command);
+        }
+        variants.push_back(variant);
+    }
+}
+
+// Workers take the next variant index from a shared counter, every world is private to its thread.
+void Sweep::run(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    used_threads = std::min<unsigned>(threads, std::max<size_t>(variants.size(), 1));
+    results.assign(variants.size(), Result());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < used_threads; ++t) {
+        workers.emplace_back([this, &next] {
+            for (size_t i = next++; i < variants.size(); i = next++)
+                run_variant(variants[i], results[i]);
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Sweep::run_variant(const Variant& variant, Result& result) const {
+    Model world;
+    world.set_sink(std::make_unique<Null_Sink>());     // Output of a variant is not printed.
+    world.load_scenario(base);
+
+    Controller controller(world);
+    for (const auto& command : variant.commands) {
+        try {
+            controller.apply(command);
+        } catch (const AttackFailedException&) {      // A failed attack is an outcome, not a bad variant.
+        } catch (const TrooperNearbyException&) {
+        } catch (const SimulationException& e) {
+            result.error = e.what();
+            return;
+        }
+    }
+
+    for (int hour = 0; hour < variant.hours; ++hour)
+        world.update();
+    result.stolen = world.get_stolen_crates();
+    result.deliveries = world.get_deliveries();
+}
+
+void Sweep::print_summary(std::ostream& out) const {
+    out << "Sweep: " << variants.size() << " variants, " << used_threads << " threads, "
+        << elapsed_ms << " ms" << std::endl;
+    out << std::left << std::setw(16) << "Variant" << std::setw(8) << "Hours"
+        << std::setw(16) << "Crates stolen" << "Deliveries" << std::endl;
+    for (size_t i = 0; i < variants.size(); ++i) {
+        out << std::setw(16) << variants[i].name << std::setw(8) << variants[i].hours;
+        if (!results[i].error.empty())
+            out << results[i].error << std::endl;
+        else
+            out << std::setw(16) << results[i].stolen << results[i].deliveries << std::endl;
+    }
+    out << std::right;
+}
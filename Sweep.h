@@ -0,0 +1,45 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Scenario.h"
+
+/**
+ * Sweep class
+ * Runs many variants of one base scenario, each in its own Model, concurrently on all cores.
+ * A variant is a list of commands (go included) applied in order, followed by a number of simulated hours.
+ * Sweep file line: <name>, <hours>, <command>; <command>; ...   ('#' starts a comment line)
+ */
+class Sweep {
+public:
+    explicit Sweep(const Scenario& _base);      // Constructor, every variant starts from this scenario.
+
+    void load(const std::string& file_name);    // Read variants from a sweep file.
+    void run(unsigned threads = 0);             // Run all variants, 0 uses every core.
+    void print_summary(std::ostream& out) const;   // Print one row per variant, in file order.
+
+private:
+    struct Variant {
+        std::string name;
+        int hours;
+        std::vector<std::string> commands;
+    };
+
+    struct Result {
+        int stolen = 0;             // Crates stolen by choppers.
+        int deliveries = 0;         // Truck arrivals at warehouses.
+        std::string error;          // First command error, the variant is not run.
+    };
+
+    void run_variant(const Variant& variant, Result& result) const;   // Run one variant in a new world.
+
+    const Scenario& base;           // Scenario shared read-only by all worlds.
+    std::vector<Variant> variants;  // Variants in file order.
+    std::vector<Result> results;    // Results, same order as variants.
+    unsigned used_threads = 0;      // Worker threads of the last run.
+    double elapsed_ms = 0;          // Wall time of the last run.
+};
+
+#endif //SWEEP_H
@@ -0,0 +1,112 @@
+#include "Telemetry_Writer.h"
+#include <cmath>
+#include <cstring>
+#include "Chopper.h"
+#include "Sim_Types.h"
+#include "SimulationException.h"
+#include "Truck.h"
+#include "Vehicle.h"
+
+Telemetry_Writer::Telemetry_Writer(const std::string& file_name) : file(file_name, std::ios::binary) {
+    if (!file.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+    file.write(TELEMETRY_MAGIC, std::strlen(TELEMETRY_MAGIC));
+    file.put(static_cast<char>(TELEMETRY_VERSION));
+    writer = std::thread(&Telemetry_Writer::write_loop, this);
+}
+
+// The writer drains the back buffer, whatever is left in the front buffer is written here.
+Telemetry_Writer::~Telemetry_Writer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();
+    file.write(reinterpret_cast<const char*>(front.data()), static_cast<std::streamsize>(front.size()));
+}
+
+// Pointers can be reused by a new vehicle after a retire, so the roster follows the registry version instead.
+void Telemetry_Writer::capture(const long seconds, const std::list<std::shared_ptr<Sim_Obj>>& objects,
+                               const std::size_t registry_version) {
+    vehicles.clear();
+    for (const auto& obj : objects)
+        if (const auto* vehicle = sim_cast<Vehicle>(obj.get()))
+            vehicles.push_back(vehicle);
+    if (!has_roster || roster_version != registry_version) {
+        has_roster = true;
+        roster_version = registry_version;
+        write_roster();
+    }
+
+    front.push_back(TELEMETRY_FRAME);
+    put_varint(front, zigzag_encode(seconds - previous_seconds));
+    previous_seconds = seconds;
+
+    const std::size_t count = vehicles.size();
+    for (auto& column : current)
+        column.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Vehicle* vehicle = vehicles[i];
+        const Point location = vehicle->get_location();
+        current[0][i] = std::llround(location.x * TELEMETRY_SCALE);
+        current[1][i] = std::llround(location.y * TELEMETRY_SCALE);
+        current[2][i] = std::llround(vehicle->get_course() * TELEMETRY_SCALE);
+        current[3][i] = std::llround(vehicle->get_speed() * TELEMETRY_SCALE);
+        current[4][i] = vehicle->get_status();
+        if (const auto* truck = sim_cast<Truck>(vehicle))
+            current[5][i] = truck->get_reported_crates();
+        else if (const auto* chopper = sim_cast<Chopper>(vehicle))
+            current[5][i] = chopper->get_stolen_crates();
+        else
+            current[5][i] = 0;
+    }
+
+    // Column by column, each value as the delta against the same vehicle in the previous frame.
+    for (std::size_t column = 0; column < TELEMETRY_COLUMNS; ++column) {
+        for (std::size_t i = 0; i < count; ++i)
+            put_varint(front, zigzag_encode(current[column][i] - previous[column][i]));
+        previous[column].swap(current[column]);
+    }
+    hand_off();
+}
+
+// Kind, name length and name per vehicle. Deltas start again from zero after a roster.
+void Telemetry_Writer::write_roster() {
+    front.push_back(TELEMETRY_ROSTER);
+    put_varint(front, vehicles.size());
+    for (const auto* vehicle : vehicles) {
+        char kind = 'S';
+        if (vehicle->get_kind() == Sim_Obj::Truck_Kind) kind = 'T';
+        else if (vehicle->get_kind() == Sim_Obj::Chopper_Kind) kind = 'C';
+        front.push_back(static_cast<std::uint8_t>(kind));
+        const std::string& name = vehicle->get_name();
+        put_varint(front, name.size());
+        front.insert(front.end(), name.begin(), name.end());
+    }
+    for (auto& column : previous)
+        column.assign(vehicles.size(), 0);
+}
+
+void Telemetry_Writer::hand_off() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!back.empty())          // Writer still busy, keep filling the front buffer.
+            return;
+        back.swap(front);
+    }
+    ready.notify_one();
+}
+
+void Telemetry_Writer::write_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready.wait(lock, [this] { return !back.empty() || stopping; });
+        if (back.empty())
+            return;
+        lock.unlock();              // The simulation thread does not touch a non-empty back buffer.
+        file.write(reinterpret_cast<const char*>(back.data()), static_cast<std::streamsize>(back.size()));
+        lock.lock();
+        back.clear();
+    }
+}
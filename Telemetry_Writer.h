@@ -0,0 +1,93 @@
+#ifndef TELEMETRY_WRITER_H
+#define TELEMETRY_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Sim_Obj.h"
+
+#define TELEMETRY_MAGIC "VTEL"                  // File starts with the magic and a version byte.
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_SCALE 100.0                   // Positions, course and speed are kept in hundredths.
+#define TELEMETRY_COLUMNS 6                     // x, y, course, speed, status, crates.
+#define TELEMETRY_ROSTER 'R'                    // Record: vehicle count, then kind, name length and name per vehicle.
+#define TELEMETRY_FRAME 'F'                     // Record: seconds delta, then every column for all vehicles.
+
+class Vehicle;
+
+// Varint and zigzag helpers shared by the writer and the reader tool.
+inline void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline std::uint64_t zigzag_encode(const std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t zigzag_decode(const std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// Reads a varint at pos, returns false if the data ends first.
+inline bool get_varint(const std::vector<std::uint8_t>& in, std::size_t& pos, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+        const std::uint8_t byte = in[pos++];
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * Telemetry_Writer class
+ * Records the state of every vehicle after each step into a columnar binary file (record <file>).
+ * Each column holds the zigzag varint delta of a vehicle value against the previous frame, so a vehicle that
+ * keeps its speed and course costs a few bytes per step. A roster record is written whenever the registry version changes.
+ * The step only encodes into the front buffer, the back buffer is written to disk by a background thread.
+ * If the writer is still busy the step keeps appending to the front buffer and never waits for the disk.
+ * tools/telemetry_reader.cpp turns a recording back into CSV.
+ */
+class Telemetry_Writer {
+public:
+    explicit Telemetry_Writer(const std::string& file_name);   // Open the file and start the writer thread.
+    ~Telemetry_Writer();                                       // Flush everything and stop the thread.
+    Telemetry_Writer(const Telemetry_Writer&) = delete;
+    Telemetry_Writer& operator=(const Telemetry_Writer&) = delete;
+
+    // Encode one frame, with a roster record first when the registry version changed.
+    void capture(long seconds, const std::list<std::shared_ptr<Sim_Obj>>& objects, std::size_t registry_version);
+
+private:
+    void write_roster();                        // Encode the current vehicles and reset the deltas.
+    void hand_off();                            // Give the front buffer to the writer if it is idle.
+    void write_loop();                          // Writer thread, writes the back buffer.
+
+    std::ofstream file;                         // Recording.
+    std::vector<const Vehicle*> vehicles;       // Vehicles of the current frame, in registry order.
+    bool has_roster = false;                    // A roster record was written.
+    std::size_t roster_version = 0;             // Registry version of the last roster record.
+    std::vector<std::int64_t> current[TELEMETRY_COLUMNS];    // Column values of this frame.
+    std::vector<std::int64_t> previous[TELEMETRY_COLUMNS];   // Column values of the previous frame.
+    long previous_seconds = 0;                  // Clock of the previous frame.
+
+    std::vector<std::uint8_t> front;            // Filled by the simulation thread.
+    std::vector<std::uint8_t> back;             // Written by the writer thread, empty when it is idle.
+    std::mutex mutex;                           // Guards back and stopping.
+    std::condition_variable ready;              // Back buffer filled or stopping.
+    bool stopping = false;                      // Writer drains and exits.
+    std::thread writer;                         // Background writer.
+};
+
+#endif //TELEMETRY_WRITER_H
@@ -1,10 +1,29 @@
 #include "Track_Base.h"
 
-Track_Base::Track_Base(const double _course, const double _speed, const Point& _position)
-: course(_course), speed(_speed), position(_position) {}
+Track_Base::Track_Base(Kinematics& _table, const double _course, const double _speed, const Point& _position,
+                       const double _speed_divisor)
+: table(_table), slot(_table.allocate(_position)), course(0), speed(_speed), dir_x(0), dir_y(1),
+  speed_divisor(_speed_divisor) {
+    set_course(_course);
+}
+
+// The velocity follows from course and speed, as for a new track.
+Track_Base::Track_Base(Kinematics& _table, const Track_State& state, const double _speed_divisor)
+: Track_Base(_table, state.course, state.speed, state.position, _speed_divisor) {
+    table.set_previous(slot, state.previous);
+    table.set_moving(slot, state.moving);
+}
+
+Track_Base::~Track_Base() {
+    table.release(slot);
+}
 
 Point Track_Base::get_position() const {
-    return position;
+    return table.get_position(slot);
+}
+
+Point Track_Base::get_previous_position() const {
+    return table.get_previous(slot);
 }
 
 double Track_Base::get_course() const {
@@ -15,26 +34,59 @@ double Track_Base::get_speed() const {
     return speed;
 }
 
+bool Track_Base::is_moving() const {
+    return table.is_moving(slot);
+}
+
+Track_State Track_Base::get_state() const {
+    return {get_position(), get_previous_position(), course, speed, is_moving()};
+}
+
 // User for Update each vehicle for a new position.
 void Track_Base::add_position(const double x, const double y) {
-    position.x += x;
-    position.y += y;
+    table.add_position(slot, x, y);
 }
 
+// Direction is recomputed only here, when the course actually changes.
 void Track_Base::set_course(const double _course) {
     course = _course;
+    const double angle_rad = course * pi / 180.0;
+    dir_x = sin(angle_rad);
+    dir_y = cos(angle_rad);
+    update_velocity();
 }
 
 void Track_Base::set_parameters(const double _speed, const double _course) {
     speed = _speed;
-    course = _course;
+    set_course(_course);
 }
 
 void Track_Base::set_position(const Point& _position) {
-    position.x = _position.x;
-    position.y = _position.y;
+    table.set_position(slot, _position);
 }
 
 void Track_Base::set_speed(const double _speed) {
     speed = _speed;
+    update_velocity();
+}
+
+void Track_Base::set_moving(const bool moving) {
+    table.set_moving(slot, moving);
+}
+
+void Track_Base::advance(const double hours) {
+    table.advance_slot(slot, hours);
+}
+
+void Track_Base::update_velocity() {
+    const double per_hour = speed / speed_divisor;
+    table.set_velocity(slot, per_hour * dir_x, per_hour * dir_y);
+}
+
+void Track_Base::hash_state(State_Hash& hash) const {
+    const Point position = get_position();
+    hash.add(position.x);
+    hash.add(position.y);
+    hash.add(course);
+    hash.add(speed);
 }
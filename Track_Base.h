@@ -1,29 +1,64 @@
 #ifndef TRACK_BASE_H
 #define TRACK_BASE_H
 
+#include <cstddef>
 #include "Geometry.h"
+#include "Kinematics.h"
+#include "State_Hash.h"
+
+/**
+ * Track_State struct
+ * Everything a track holds, copied when a vehicle moves into another world (a region of a sharded world).
+ */
+struct Track_State {
+    Point position;         // Current position.
+    Point previous;         // Position before the last movement.
+    double course;          // Current course.
+    double speed;           // Current speed.
+    bool moving;            // Flagged for the next movement.
+};
 
 /**
  * Track_Base class
  * Manages basic tracking data (position, speed, course) for a moving object.
+ * Position and velocity live in a shared Kinematics table, the unit direction of the course
+ * is cached so movement needs no trigonometry per tick.
  * Provides setters and getters for track data.
  */
 class Track_Base{
 public:
-    Track_Base(double _course, double _speed, const Point& _position);  // Constructor.
+    Track_Base(Kinematics& _table, double _course, double _speed, const Point& _position,
+               double _speed_divisor);   // Constructor.
+    Track_Base(Kinematics& _table, const Track_State& state, double _speed_divisor);    // Restore a copied track.
+    Track_Base(const Track_Base&) = delete;
+    Track_Base& operator=(const Track_Base&) = delete;
+    ~Track_Base();                  // Releases the Kinematics slot.
+
     Point get_position() const;     // Get position.
+    Point get_previous_position() const;  // Get position before the last movement.
     double get_course() const;      // Get course.
     double get_speed() const;       // Get speed.
+    bool is_moving() const;         // Will the next movement move this track?
+    Track_State get_state() const;  // Copy of the whole track.
 
     void add_position(double x, double y);               // Adjust position by offset.
     void set_parameters(double _speed, double _course);  // Set speed and course.
     void set_course(double _course);                     // Set course.
     void set_position(const Point& _position);           // Set position.
     void set_speed(double _speed);                       // Set speed.
+    void set_moving(bool moving);                        // Flag the track for the next movement.
+    void advance(double hours);                          // Move this track only.
+    void hash_state(State_Hash& hash) const;             // Mix position, course and speed into a checksum.
 
 private:
-    double course;      // Current course.
-    double speed;       // Current speed.
-    Point position;     // Current position.
+    void update_velocity();                             // Push speed * direction into the table.
+
+    Kinematics& table;      // Shared position / velocity storage.
+    std::size_t slot;       // Index inside the table.
+    double course;          // Current course.
+    double speed;           // Current speed.
+    double dir_x;           // Cached sin(course).
+    double dir_y;           // Cached cos(course).
+    double speed_divisor;   // Converts speed into map distance per hour.
 };
-#endif //TRACK_BASE_H
\ No newline at end of file
+#endif //TRACK_BASE_H
@@ -1,11 +1,35 @@
 #include "Truck.h"
 
 #include <iostream>
+#include <utility>
 
 #include "Model.h"
+#include "Schedule_Stream.h"
+#include "Shard_Channel.h"
+#include "SimulationException.h"
+
+Truck::Truck(Model& model, const std::string& name, const double speed, const double course, const Point& pos,
+             std::vector<TruckLeg> itinerary, std::unique_ptr<Schedule_Stream> _stream)
+    : Vehicle(model, name, KIND, speed, course, pos, TRUCK_SPEED_DIVISOR), legs(std::move(itinerary)),
+      stream(std::move(_stream)) {
+    for (const auto& leg : legs)
+        cargo += leg.crates;
+    if (stream)
+        cargo += stream->get_remaining_crates();
+}
+
+// The finished mark and completed flag are not packed, a sharded world does not archive.
+Truck::Truck(Model& model, Shard_Message& message) : Vehicle(model, KIND, message, TRUCK_SPEED_DIVISOR) {
+    legs.resize(message.get<std::uint32_t>());
+    for (auto& leg : legs)
+        leg = unpack_leg(model, message);
+    cursor = message.get<std::size_t>();
+    cargo = message.get<int>();
+    if (message.get<bool>())
+        stream = std::make_unique<Schedule_Stream>(model, message);
+}
 
-Truck::Truck(const std::string& name, const double speed, const double course, const Point& pos, const std::list<Details>& path)
-    : Vehicle(name, speed, course, pos), truck_path(path) {}
+Truck::~Truck() = default;
 
 // Sets the course for the truck, but cancels his route.
 void Truck::set_course(const double course) {
@@ -13,40 +37,49 @@ void Truck::set_course(const double course) {
     cancel_route();
 }
 
+// A truck without a route no longer moves, so it reports as stopped.
 void Truck::cancel_route() {
-    truck_path.clear();
+    std::vector<TruckLeg>().swap(legs);
+    stream.reset();
+    cursor = 0;
+    cargo = 0;
+    completed = false;
+    if (get_status() != OffRoad)
+        set_status(Stopped);
 }
 
 // Broadcast the truck state.
-void Truck::broadcast_current_state() const {
-    int crates = unload();
+void Truck::broadcast_current_state(Status_Text& out) const {
     std::string line;
     switch (get_status()) {
         case OffRoad:
             line = "Off road";
-            crates = 0;
             break;
         case Stopped:
             line = "Stopped";
             break;
         case Parked:
-            line = "Parked at " +truck_path.front().get_location_name();
-            crates -= truck_path.front().get_case_quantity();
+            line = "Parked at " + legs[cursor].warehouse->get_name();
             break;
         default:
-            line = "Heading to " + truck_path.front().get_location_name();
+            line = "Heading to " + legs[cursor].warehouse->get_name();
             break;
     }
-    std::cout << "Truck " << get_name() << " at ";
-    get_location().print();
-    std::cout << ", " << line << ", Crates: " << crates << std::endl;
+    out << "Truck " << get_name() << " at " << get_location();
+    out << ", " << line << ", Crates: " << get_reported_crates() << '\n';
 }
 
 int Truck::unload() const {
-    int stolen = 0;
-    for (auto& stop : truck_path)
-        stolen += stop.get_case_quantity();
-    return stolen;
+    return cargo;
+}
+
+// A robbed truck has nothing on board, a parked one already unloaded at its stop.
+int Truck::get_reported_crates() const {
+    switch (get_status()) {
+        case OffRoad: return 0;
+        case Parked: return cargo - legs[cursor].crates;
+        default: return cargo;
+    }
 }
 
 // Truck doesnt support this function.
@@ -58,66 +91,121 @@ void Truck::set_position(Point& pos) {
     cancel_route();
 }
 
-void Truck::update() {
-    // Robbed, or stopped, or path ended return.
-    if (get_status() == Stopped || get_status() == OffRoad || truck_path.empty())
-        return;
-
-    // Truck at warehouse, calculate the time for departure.
-    const int minutes_to_departure = calculate_time_minutes(Model::get_instance().get_sim_time(),
-                                                        truck_path.front().get_departure_time());
-    if (get_status() == Parked) {   // Truck is parked at a warehouse.
+bool Truck::begin_step() {
+    bool moving = true;
+    // Robbed, or stopped, or path ended, the truck stays.
+    if (get_status() == Stopped || get_status() == OffRoad || cursor >= legs.size())
+        moving = false;
+    else if (get_status() == Parked) {   // Truck is parked at a warehouse.
+        // Truck at warehouse, calculate the time for departure.
+        const int minutes_to_departure = legs[cursor].departure_minute - get_model().get_minute_of_day();
         if (minutes_to_departure > 0) {
-            return;
+            moving = false;
+        } else {
+            set_status(MovingTo);      // Advance the Truck path, the crates of this stop were unloaded.
+            cargo -= legs[cursor].crates;
+            ++cursor;
         }
-        set_status(MovingTo);      // Advance the Truck path.
-        truck_path.pop_front();
     }
+    Vehicle::set_moving(moving);
+    return moving;
+}
 
-    const std::string warehouse_name = truck_path.front().get_location_name();
-    Warehouse* wh = Model::get_instance().find_warehouse_by_name(warehouse_name);
+bool Truck::is_dormant() const {
+    return get_status() == Stopped || get_status() == OffRoad || cursor >= legs.size();
+}
 
-    const Point prev_pos = get_location();
+// A truck stopped by a command mid-route is dormant but not finished, it stays in the live world.
+bool Truck::is_finished() const {
+    return get_status() == OffRoad || completed;
+}
 
-    set_speed(get_speed() * 100);
-    Vehicle::update();
-    set_speed(get_speed() / 100);
+std::size_t Truck::get_finished_mark() const {
+    return finished_mark;
+}
+
+void Truck::set_finished_mark(const std::size_t mark) {
+    finished_mark = mark;
+}
+
+void Truck::end_step() {
+    if (!is_moving())
+        return;
 
-    // Check if truck passed the warehouse target.
-    if (has_passed_target(prev_pos, wh->get_location(), get_location())) {
+    Warehouse* wh = legs[cursor].warehouse;
+
+    // Check if truck reached or passed the warehouse target.
+    if (has_reached_target(get_previous_location(), wh->get_location(), get_location())) {
         // Forcefully park the truck, and update warehouse inventory.
         set_status(Parked);
         Point from(wh->get_location());
         Vehicle::set_position(from);
-        wh->update_inventory(truck_path.front().get_case_quantity(),true);
-
-        // Check if the truck has another warehouse.
-        if (!truck_path.empty()) {
-            const Details& front = truck_path.front();
-            truck_path.pop_front();
-
-            // Current is last stop of the truck.
-            if (truck_path.empty()) {
-                set_status(Stopped);
-                truck_path.push_front(front);
-                return;
-            }
-
-            // Set the next destination for the truck.
-            const std::string drive_to = truck_path.front().get_location_name();
-            const Warehouse* destination = Model::get_instance().find_warehouse_by_name(drive_to);
-            const Point to = destination->get_location();
-
-            // Calculate new speed, with course.
-            const double dist = calculate_distance(from, to);
-            const int mins = time_difference_minutes(front.get_departure_time(), front.get_arrival_time());
-            const double speed = dist / (mins / 60.0);
-            const double course = calculate_course_deg(from, to);
-            set_parameters(speed, course);
-
-            truck_path.push_front(front);
-        } else {
+        wh->update_inventory(legs[cursor].crates, true);
+        get_model().record_delivery();
+        refill();                       // May move the window, legs[cursor] stays this stop.
+
+        // Current is last stop of the truck.
+        if (cursor + 1 == legs.size()) {
             set_status(Stopped);
+            completed = true;
+            return;
         }
+
+        // Set the precomputed leg to the next warehouse.
+        set_parameters(legs[cursor].speed, legs[cursor].course);
+    }
+}
+
+// Visited legs are dropped and the window is filled again. A bad line later in the file is reported
+// with its line number, the truck then ends its route at the last leg it holds.
+void Truck::refill() {
+    if (!stream || cursor + 1 < legs.size())
+        return;
+    legs.erase(legs.begin(), legs.begin() + static_cast<std::ptrdiff_t>(cursor));
+    cursor = 0;
+    try {
+        stream->read(get_model(), legs, SCHEDULE_WINDOW);
+    } catch (const SimulationException& e) {
+        get_model().report(get_order(), e.what());
+        cargo -= stream->get_remaining_crates();
+        stream.reset();
+        return;
     }
+    if (stream->exhausted())
+        stream.reset();
+}
+
+// Legs left in the window and the stream position identify where the truck is in its schedule.
+void Truck::hash_state(State_Hash& hash) const {
+    Vehicle::hash_state(hash);
+    hash.add(static_cast<std::uint64_t>(cursor));
+    hash.add(static_cast<std::uint64_t>(legs.size()));
+    hash.add(cargo);
+    hash.add(stream ? stream->get_remaining_crates() : -1);
+}
+
+void Truck::pack(Shard_Message& message) const {
+    Vehicle::pack(message);
+    message.put(static_cast<std::uint32_t>(legs.size()));
+    for (const auto& leg : legs)
+        pack_leg(leg, message);
+    message.put(cursor);
+    message.put(cargo);
+    message.put(stream != nullptr);
+    if (stream)
+        stream->pack(message);
+}
+
+void pack_leg(const TruckLeg& leg, Shard_Message& message) {
+    message.put(static_cast<std::uint32_t>(leg.warehouse->get_index()));
+    message.put(leg.crates);
+    message.put(leg.departure_minute);
+    message.put(leg.speed);
+    message.put(leg.course);
+}
+
+// Fields are read one by one, the order of evaluation inside a braced list is fixed.
+TruckLeg unpack_leg(const Model& model, Shard_Message& message) {
+    return {model.get_warehouses().at(message.get<std::uint32_t>()), message.get<int>(), message.get<int>(),
+            message.get<double>(), message.get<double>()};
 }
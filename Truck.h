@@ -1,30 +1,75 @@
 #ifndef TRUCK_H
 #define TRUCK_H
 
-#include <list>
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include "Vehicle.h"
-#include "Details.h"
+
+#define TRUCK_SPEED_DIVISOR 1.0                             // Trucks move their full speed per hour.
+
+class Model;
+class Schedule_Stream;
+class Shard_Message;
+class Warehouse;
+
+/**
+ * TruckLeg struct
+ * One stop of a compiled truck itinerary, the warehouse is resolved and the leg to the next stop is precomputed.
+ */
+struct TruckLeg {
+    Warehouse* warehouse;        // Stop warehouse.
+    int crates;                  // Crates unloaded at the stop.
+    int departure_minute;        // Departure from the stop, minutes since 00:00.
+    double speed;                // Speed of the leg to the next stop.
+    double course;               // Course of the leg to the next stop.
+};
+
+void pack_leg(const TruckLeg& leg, Shard_Message& message);         // Append a leg, the warehouse by index.
+TruckLeg unpack_leg(const Model& model, Shard_Message& message);   // Read a leg written by pack_leg.
 
 /**
  * Truck class, extends Vehicle
  * Represents a truck moving between warehouses on a predefined path.
+ * The path is compiled by the Model into a flat itinerary of legs, the truck only moves a cursor over it
+ * and keeps a running total of the crates still on board.
+ * A long schedule is streamed, the truck then holds a window of legs and refills it from the file on arrival.
  * Overrides base Vehicle functions and manages a path of deliveries.
  */
 class Truck final : public Vehicle{
 public:
-    Truck(const std::string& name, double speed, double course, const Point& pos, const std::list<Details>& path);
+    static constexpr Kind KIND = Truck_Kind;
+    Truck(Model& model, const std::string& name, double speed, double course, const Point& pos,
+          std::vector<TruckLeg> itinerary, std::unique_ptr<Schedule_Stream> stream = nullptr);
+    Truck(Model& model, Shard_Message& message);   // Unpack a truck packed by another world.
+    ~Truck() override;
 
     void set_destination(const std::string& warehouse_name) override; // Set truck destination, overridden from Vehicle.
     void set_course(double course) override;                          // Set course, overridden from Vehicle.
     void set_position(Point& pos) override;                           // Set position, overridden from Vehicle.
-    void broadcast_current_state() const override;                    // Broadcast truck state, overridden from Vehicle.
+    void broadcast_current_state(Status_Text& out) const override;                    // Broadcast truck state, overridden from Vehicle.
 
     void cancel_route();                // Cancel truck route.
     int unload() const;                 // Count all cargo to unload.
-    void update() override;             // Update truck state.
+    int get_reported_crates() const;    // Crates its status line shows.
+    bool begin_step() override;         // Departure handling, decides if the truck moves.
+    void end_step() override;           // Arrival handling after the truck moved.
+    bool is_dormant() const;            // Robbed, stopped or at the end of its path.
+    bool is_finished() const;           // Robbed or arrived at the last stop of its path, may be archived.
+    std::size_t get_finished_mark() const;          // Mark of its entry among the Model's finished trucks, 0 if none.
+    void set_finished_mark(std::size_t mark);       // Set by the Model when it queues / drops that entry.
+    void hash_state(State_Hash& hash) const override;   // Adds the itinerary cursor and cargo.
+    void pack(Shard_Message& message) const override;   // Adds the itinerary, cursor, cargo and stream.
 
 private:
-    std::list<Details> truck_path;  // Path of warehouses to visit.
+    void refill();                      // Read more legs once the window ends at the current stop.
+
+    std::vector<TruckLeg> legs;         // Stops to visit, in order.
+    std::size_t cursor = 0;             // Current stop, the one headed to or parked at.
+    int cargo = 0;                      // Crates of the stops from the cursor on.
+    bool completed = false;             // Arrived at the last stop, not merely stopped by a command.
+    std::size_t finished_mark = 0;      // Finished entry it is queued under, 0 if none.
+    std::unique_ptr<Schedule_Stream> stream;    // Rest of a streamed schedule, null once fully read.
 };
 
-#endif //TRUCK_H
\ No newline at end of file
+#endif //TRUCK_H
@@ -0,0 +1,69 @@
+#include "Truck_Archive.h"
+#include <iomanip>
+#include "SimulationException.h"
+#include "Truck.h"
+
+// The crates are the ones its status line shows, none for a robbed truck.
+void Truck_Archive::add(const Truck& truck, const int time) {
+    const bool robbed = truck.get_status() == Vehicle::OffRoad;
+    const Point location = truck.get_location();
+    const std::string& name = truck.get_name();
+    Entry entry{static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(name.size()),
+                location.x, location.y, truck.get_reported_crates(), time, robbed};
+    ++count;
+    if (spill_file.is_open()) {
+        print(spill_file, name, entry);
+        return;
+    }
+    names += name;
+    entries.push_back(entry);
+}
+
+// The entries already in memory move into the file first. The file is appended to, so lines already in it
+// stay, and a second spill file is refused since the history would be split between files.
+void Truck_Archive::spill(const std::string& file_name) {
+    if (spill_file.is_open()) {
+        if (file_name != spill_name)
+            throw InvalidArgumentException("Error: Archive is already spilled to <" + spill_name + ">");
+        return;
+    }
+    std::ofstream file(file_name, std::ios::app);
+    if (!file.is_open())
+        throw FileException("Error: Could not open file <" + file_name + ">");
+    file.seekp(0, std::ios::end);
+    spill_start = file.tellp();
+    file.precision(2);
+    file << std::fixed;
+    spill_file = std::move(file);
+    spill_name = file_name;
+    for (const auto& entry : entries)
+        print(spill_file, std::string_view(names).substr(entry.name, entry.name_length), entry);
+    std::vector<Entry>().swap(entries);
+    std::string().swap(names);
+}
+
+void Truck_Archive::print(std::ostream& out) {
+    if (spill_file.is_open()) {
+        spill_file.flush();
+        std::ifstream file(spill_name);
+        file.seekg(spill_start);
+        std::string line;
+        while (std::getline(file, line))
+            out << line << '\n';
+    } else {
+        for (const auto& entry : entries)
+            print(out, std::string_view(names).substr(entry.name, entry.name_length), entry);
+    }
+    out.flush();
+}
+
+std::size_t Truck_Archive::size() const {
+    return count;
+}
+
+// The name is passed in, a spilled entry is printed before its name is stored.
+void Truck_Archive::print(std::ostream& out, const std::string_view name, const Entry& entry) const {
+    out << "Truck " << name << " at (" << std::setprecision(2) << entry.x << ", " << entry.y << "), "
+        << (entry.robbed ? "Off road" : "Stopped") << ", Crates: " << entry.crates
+        << ", archived at time " << entry.time << '\n';
+}
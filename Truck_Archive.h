@@ -0,0 +1,47 @@
+#ifndef TRUCK_ARCHIVE_H
+#define TRUCK_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Truck;
+
+/**
+ * Truck_Archive class
+ * Read-only history of trucks retired from the Model after they finished their path or were robbed.
+ * Each truck is kept as one fixed size entry of its final state, names are packed into one string.
+ * With a spill file the entries are appended there as status lines instead of being kept in memory.
+ * The history has one spill file, spilling again names the same file.
+ */
+class Truck_Archive {
+public:
+    void add(const Truck& truck, int time);             // Keep the final state of a truck retired at time.
+    void spill(const std::string& file_name);           // Append entries to the file from now on, FileException.
+    void print(std::ostream& out);                      // Print every archived truck as a status line.
+    std::size_t size() const;                           // Trucks archived so far.
+
+private:
+    struct Entry {
+        std::uint32_t name;                             // Offset of the name in names.
+        std::uint32_t name_length;                      // Length of the name.
+        double x, y;                                    // Last position.
+        std::int32_t crates;                            // Crates still on board.
+        std::int32_t time;                              // Time the truck was archived.
+        bool robbed;                                    // Off road, otherwise stopped.
+    };
+    void print(std::ostream& out, std::string_view name, const Entry& entry) const;   // One status line.
+
+    std::vector<Entry> entries;                         // Entries in memory, none while spilling.
+    std::string names;                                  // Names of the entries in memory.
+    std::ofstream spill_file;                           // Spilled entries, when open.
+    std::string spill_name;                             // Name of the spill file.
+    std::streamoff spill_start = 0;                     // Where this archive's lines start in the file.
+    std::size_t count = 0;                              // Archived trucks, spilled ones included.
+};
+
+#endif //TRUCK_ARCHIVE_H
@@ -14,14 +14,35 @@ std::vector<std::string> split_line(const std::string& line){
     return tokens;
 }
 
-bool is_number(const std::string& s) {
-    const std::regex pattern(NUMBER_FORMAT);
-    return std::regex_match(s, pattern);
+// Number of leading digits of s.
+static std::size_t count_digits(const std::string_view s) {
+    std::size_t i = 0;
+    while (i < s.size() && s[i] >= '0' && s[i] <= '9') ++i;
+    return i;
 }
 
-bool is_valid_sim_name(const std::string& warehouse) {
-    const std::regex pattern(STRING_PATTERN);
-    return !warehouse.empty() && std::regex_match(warehouse, pattern);
+// Matches digits, a dot and exactly decimals digits, or digits with an optional fraction when decimals is 0.
+static bool is_decimal(const std::string_view s, const std::size_t decimals) {
+    const std::size_t whole = count_digits(s);
+    if (whole == 0) return false;
+    if (whole == s.size()) return decimals == 0;
+    if (s[whole] != '.') return false;
+    const std::size_t fraction = count_digits(s.substr(whole + 1));
+    if (whole + 1 + fraction != s.size() || fraction == 0) return false;
+    return decimals == 0 || fraction == decimals;
+}
+
+// Hand matched NUMBER_FORMAT, commands are checked without building a regex.
+bool is_number(const std::string_view s) {
+    return is_decimal(!s.empty() && s[0] == '-' ? s.substr(1) : s, 0);
+}
+
+// Hand matched STRING_PATTERN.
+bool is_valid_sim_name(const std::string_view warehouse) {
+    if (warehouse.empty() || warehouse.size() > MAX_STRING_LENGTH) return false;
+    for (const char c : warehouse)
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) return false;
+    return true;
 }
 
 bool is_valid_truck_name(const std::string& truck_name) {
@@ -38,11 +59,10 @@ bool is_valid_time(const std::string& arrival, const std::string& departure) {
     return std::regex_match(arrival, pattern) && std::regex_match(departure, pattern);
 }
 
-bool is_valid_coordinate_pair(const std::string& left, const std::string& right) {
-    const std::regex pattern1(COORDINATE_LEFT);
-    const std::regex pattern2(COORDINATE_RIGHT);
-    return std::regex_match(left, pattern1) &&
-           std::regex_match(right, pattern2);
+// Hand matched COORDINATE_LEFT and COORDINATE_RIGHT.
+bool is_valid_coordinate_pair(const std::string_view left, const std::string_view right) {
+    return left.size() > 1 && left.front() == '(' && is_decimal(left.substr(1), 2) &&
+           right.size() > 1 && right.back() == ')' && is_decimal(right.substr(0, right.size() - 1), 2);
 }
 
 void convert_tokens(std::vector<std::string>& tokens) {
@@ -73,36 +93,9 @@ void clean_strings(std::vector<std::string>& coordinates) {
     coordinates[3].erase(0, 1);
 }
 
-std::time_t create_time_for_ticks() {
-    const std::string t_st = "01/01 00:00";
-    std::tm tm = {};
-    std::istringstream ss(t_st);
-    ss >> std::get_time(&tm, TIME_FORMAT);
-    const std::time_t now = std::time(nullptr);
-    const std::tm today = *std::localtime(&now);
-    tm.tm_year = today.tm_year;
-    tm.tm_mon = today.tm_mon;
-    tm.tm_mday = today.tm_mday;
-    tm.tm_sec = 0;
-    tm.tm_isdst = 1;
-    const std::time_t temp =std::mktime(&tm);
-    return temp;
-}
-
-int calculate_time_minutes(const std::time_t sim_time, const std::string &input) {
-    const std::tm sim_tm = *std::localtime(&sim_time);
-
-    std::tm time_tm = sim_tm;
-    std::istringstream stream(input);
-    stream >> std::get_time(&time_tm, "%H:%M");
-
-    time_tm.tm_sec = 0;
-    time_tm.tm_isdst = sim_tm.tm_isdst;
-
-    const std::time_t input_time = std::mktime(&time_tm);
-
-    const int diffMinutes = static_cast<int>(std::difftime(input_time, sim_time) / 60);
-    return diffMinutes;
+// Pure arithmetic, no localtime / mktime, so it is safe to call from several simulation threads.
+int calculate_time_minutes(const int minute_of_day, const std::string &input) {
+    return time_difference_minutes("00:00", input) - minute_of_day;
 }
 
 bool has_passed_target(const Point& from, const Point& target, const Point& current) {
@@ -115,6 +108,10 @@ bool has_passed_target(const Point& from, const Point& target, const Point& curr
     return (dx1 * dx2 + dy1 * dy2) < 0;
 }
 
+bool has_reached_target(const Point& from, const Point& target, const Point& current) {
+    return calculate_distance(from, current) + ARRIVAL_EPSILON >= calculate_distance(from, target);
+}
+
 std::string trim(const std::string& str) {
     const auto start = str.find_first_not_of(" \t\r\n");
     const auto end = str.find_last_not_of(" \t\r\n");
@@ -1,10 +1,15 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <charconv>
 #include <regex>
+#include <string_view>
 #include "Geometry.h"
+#include "Sim_Obj.h"
+#include "SimulationException.h"
 
 #define MAX_STRING_LENGTH 12                                // Maximum string length.
+#define ARRIVAL_EPSILON 1e-9                                // Distance (km) below which a target counts as reached.
 #define STRING_PATTERN "^[a-zA-Z]{1,12}$"                   // String pattern (Only letters).
 #define TIME_PATTERN "^\\d{2}:\\d{2}$"                      // Time Pattern ("10:00").
 #define COORDINATE_LEFT "^\\(\\d+\\.\\d{2}$"                // Left coordinate. ("(10.30,")
@@ -15,8 +20,10 @@
 #define POLICE "State_trooper"
 
 // Struct that is used in delaying Chopper attacks to the next ticks if needed.
+// The order finds the truck again after either of them moved into another region of a sharded world.
 struct AttackCommand {
-    std::string target;
+    Handle target;      // Truck to attack, stale if the truck is gone or was moved.
+    std::size_t order;  // Registry order of the truck.
     int tick;
 };
 
@@ -25,11 +32,11 @@ std::vector<std::string> split_line(const std::string& line);
 
 // Function that checks if a given string is in the pattern of a number, defined in .h
 // Returns true if it is, false otherwise.
-bool is_number(const std::string& s);
+bool is_number(std::string_view s);
 
 // Function that checks if a given string is in a string pattern, defined in .h
 // Returns true if it is, false otherwise.
-bool is_valid_sim_name(const std::string& warehouse);
+bool is_valid_sim_name(std::string_view warehouse);
 
 // Function that checks if a given filename is in a string pattern, defined in .h
 // Returns true if it is, false otherwise.
@@ -41,7 +48,18 @@ bool is_valid_time(const std::string& arrival, const std::string& departure);
 
 // Function that checks if 2 strings given are in the coordinate pattern, defined in .h
 // Returns true if they are, false otherwise.
-bool is_valid_coordinate_pair(const std::string& left, const std::string& right);
+bool is_valid_coordinate_pair(std::string_view left, std::string_view right);
+
+// Function that parses a string already matched as a number, without allocating.
+// Throws InvalidArgumentException if the value does not fit the type.
+template<typename T>
+T parse_number(const std::string_view s) {
+    T value{};
+    const auto [end, error] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (error != std::errc())
+        throw InvalidArgumentException("Error: Number is out of range");
+    return value;
+}
 
 // Function that changes and checks the vector for its content, and changes
 // the vector in place.
@@ -54,16 +72,18 @@ bool is_valid_truck_line(const std::vector<std::string>& line);
 // "Cleans" the vector from non-needed parameters in place.
 void clean_strings(std::vector<std::string>& coordinates);
 
-// Function that returns the time "00:00" for the main simulation.
-std::time_t create_time_for_ticks();
-
-// Function that returns the difference between simulation time and a input string.
-int calculate_time_minutes(std::time_t sim_time, const std::string &input);
+// Function that returns the difference in minutes between the simulation clock (minutes since 00:00)
+// and an input time string ("10:00").
+int calculate_time_minutes(int minute_of_day, const std::string &input);
 
 // Function that returns true if the dot product between target and from, and target with current smaller than 0.
 // Returns false otherwise.
 bool has_passed_target(const Point& from, const Point& target, const Point& current);
 
+// Function that returns true if the step from -> current is at least as long as the distance from -> target,
+// up to ARRIVAL_EPSILON, so a vehicle landing exactly on its target counts as arrived.
+bool has_reached_target(const Point& from, const Point& target, const Point& current);
+
 // Function that takes a string, and trims the end. (/r, /n, /t, ' ')
 std::string trim(const std::string& str);
 #endif //UTILS_H
\ No newline at end of file
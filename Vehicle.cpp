@@ -1,8 +1,17 @@
 #include "Vehicle.h"
+#include "Model.h"
+#include "Shard_Channel.h"
 
 // Vehicle Constructor.
-Vehicle::Vehicle(const std::string& name, const double speed, const double course, const Point& position)
-: Sim_Obj(name), base(course, speed, position) {}
+Vehicle::Vehicle(Model& _model, const std::string& name, const Kind kind, const double speed, const double course,
+                 const Point& position, const double speed_divisor)
+: Sim_Obj(name, kind), model(_model), base(_model.get_kinematics(), course, speed, position, speed_divisor) {}
+
+// Fields are read in the order pack() wrote them, members are initialized in declaration order.
+Vehicle::Vehicle(Model& _model, const Kind kind, Shard_Message& message, const double speed_divisor)
+: Sim_Obj(message.get_text(), kind), status(message.get<int>()), awake(message.get<bool>()),
+  order(message.get<std::size_t>()), model(_model),
+  base(_model.get_kinematics(), message.get<Track_State>(), speed_divisor) {}
 
 // Sets the vehicle parameters via Track_Base private field.
 void Vehicle::set_parameters(const double speed, const double course) {
@@ -24,9 +33,10 @@ void Vehicle::set_speed(const double speed) {
     base.set_speed(speed);
 }
 
-// Sets the vehicle status.
+// Sets the vehicle status, a sleeping vehicle wakes up.
 void Vehicle::set_status(const int _status) {
     status = _status;
+    wake();
 }
 
 // Returns the vehicle position via Track_base private field.
@@ -66,11 +76,81 @@ std::string Vehicle::get_status_string() const {
     }
 }
 
-// Updates vehicle position on a map, calculate the next location of the vehicle and add the points
-// To the current position.
-void Vehicle::update() {
-    const double angle_rad = base.get_course() * pi / 180.0;
-    const double dx = (base.get_speed() / 100.0) * sin(angle_rad);
-    const double dy = (base.get_speed() / 100.0) * cos(angle_rad);
-    base.add_position(dx, dy);
-}
\ No newline at end of file
+// By default a vehicle moves unless it is stopped.
+bool Vehicle::begin_step() {
+    const bool moving = status != Stopped;
+    set_moving(moving);
+    return moving;
+}
+
+// Default vehicle has nothing to do after moving.
+void Vehicle::end_step() {}
+
+// A stopped vehicle stays stopped until a command moves it.
+bool Vehicle::is_dormant() const {
+    return status == Stopped;
+}
+
+bool Vehicle::is_awake() const {
+    return awake;
+}
+
+void Vehicle::set_awake(const bool _awake) {
+    awake = _awake;
+}
+
+std::size_t Vehicle::get_order() const {
+    return order;
+}
+
+void Vehicle::set_order(const std::size_t _order) {
+    order = _order;
+}
+
+void Vehicle::wake() {
+    if (awake) return;
+    awake = true;
+    model.wake(*this);
+}
+
+// Flags the vehicle to be moved by the next Kinematics advance.
+void Vehicle::set_moving(const bool moving) {
+    base.set_moving(moving);
+}
+
+// Returns the world this vehicle lives in.
+Model& Vehicle::get_model() const {
+    return model;
+}
+
+// Returns true if the vehicle was flagged to move on this step.
+bool Vehicle::is_moving() const {
+    return base.is_moving();
+}
+
+// Returns the vehicle position before the last movement.
+Point Vehicle::get_previous_location() const {
+    return base.get_previous_position();
+}
+
+// Updates a single vehicle on a map, Model moves all vehicles at once through Kinematics::advance,
+// this is the same step for one vehicle.
+void Vehicle::update(const double hours) {
+    begin_step();
+    base.advance(hours);
+    end_step();
+}
+
+void Vehicle::hash_state(State_Hash& hash) const {
+    hash.add(get_name());
+    hash.add(status);
+    base.hash_state(hash);
+}
+
+void Vehicle::pack(Shard_Message& message) const {
+    message.put_text(get_name());
+    message.put(status);
+    message.put(awake);
+    message.put(order);
+    message.put(base.get_state());
+}
@@ -4,21 +4,31 @@
 #include "Sim_Obj.h"
 #include "Track_Base.h"
 
+#define VEHICLE_SPEED_DIVISOR 100.0                         // Map distance per hour is speed / divisor.
+
+class Model;
+class Shard_Message;
+
 /**
  * Vehicle class, extends Sim_obj
  * Each vehicle (truck, chopper, trooper) extends this base class.
  * Contains basic virtual and non-virtual functions.
+ * Each vehicle is bound to the Model (world) it lives in.
+ * A dormant vehicle (see is_dormant) sleeps: the Model skips it on every step until a change of its state wakes it.
  */
 class Vehicle : public Sim_Obj{
 public:
     enum {Stopped,Parked,OffRoad,MovingOnCourse,MovingTo};  // All vehicle states.
-    explicit Vehicle(const std::string& name, double speed, double course, const Point& position);
+    Vehicle(Model& _model, const std::string& name, Kind kind, double speed, double course, const Point& position,
+            double speed_divisor = VEHICLE_SPEED_DIVISOR);
+    Vehicle(Model& _model, Kind kind, Shard_Message& message,
+            double speed_divisor = VEHICLE_SPEED_DIVISOR);          // Unpack a vehicle packed by another world.
 
     virtual void set_destination(const std::string &warehouse_name) = 0; // Virtual set vehicle destination.
     virtual void set_parameters(double speed, double course);            // Set vehicle parameters.
     virtual void set_course(double course);                              // Set course.
     virtual void set_position(Point& pos);                               // Set vehicle position.
-    void broadcast_current_state() const override = 0;                   // Virtual broadcast state , overridden from Sim_obj.
+    void broadcast_current_state(Status_Text& out) const override = 0;                   // Virtual broadcast state , overridden from Sim_obj.
 
     void set_speed(double speed);   // Speed setter.
     void set_status(int _status);   // Status setter (vehicle state).
@@ -30,11 +40,31 @@ public:
     bool is_stopped() const;                // Is the vehicle in stopped state?
     std::string get_status_string() const;  // Get status string (vehicle state).
 
-    void update() override;                 // Updates vehicle state, overridden from Sim_obj
+    virtual bool begin_step();              // Decide if the vehicle moves this step, flags its Kinematics slot.
+    virtual void end_step();                // React to the movement (arrivals, attacks).
+    bool is_moving() const;                 // Was the vehicle flagged to move this step?
+    bool is_dormant() const;                // Does nothing on a step until its state is changed?
+    bool is_awake() const;                  // Is the vehicle among the Model's active vehicles?
+    void set_awake(bool _awake);            // Set by the Model when the vehicle joins / leaves the active vehicles.
+    std::size_t get_order() const;          // Registry order, active vehicles are stepped in this order.
+    void set_order(std::size_t _order);     // Set by the Model when the vehicle is registered.
+    Point get_previous_location() const;    // Location before the last movement.
+
+    void update(double hours) override;     // Single vehicle step (begin, move, end), overridden from Sim_obj
+    void hash_state(State_Hash& hash) const override;   // Track and status, subclasses add their own state.
+    virtual void pack(Shard_Message& message) const;    // Name, status, order and track, subclasses add their own state.
     ~Vehicle() override = default;          // Destructor.
 
+protected:
+    void set_moving(bool moving);           // Flag the Kinematics slot for the next movement.
+    void wake();                            // State changed, the Model steps the vehicle again.
+    Model& get_model() const;               // World this vehicle lives in.
+
 private:
     int status = Stopped;                   // Vehicle status.
+    bool awake = true;                      // Among the active vehicles, or not registered yet.
+    std::size_t order = 0;                  // Registry order.
+    Model& model;                           // World this vehicle lives in.
     Track_Base base;                        // All basic information (speed, course, location) of a vehicle.
 };
 #endif //VEHICLE_H
\ No newline at end of file
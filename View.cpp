@@ -1,6 +1,6 @@
 #include "View.h"
 #include <iomanip>
-#include <iostream>
+#include <ostream>
 #include "Model.h"
 #include "SimulationException.h"
 
@@ -11,10 +11,10 @@ View::View(const double _scale, const int _size, const Point& _pan) {
     span = _pan;
 }
 
-// Set map size, only if size > 6 and size <= 30,
+// Set map size, only if size > 6 and size <= 30 (MAX_DENSITY_SIZE in density mode),
 // throw exception otherwise.
 void View::set_size(const int _size) {
-    if (_size > MIN_SIZE && _size <= MAX_SIZE)
+    if (_size > MIN_SIZE && _size <= (density ? MAX_DENSITY_SIZE : MAX_SIZE))
         size = _size;
     else
         throw InvalidArgumentException("Error: Size is out of range");
@@ -42,24 +42,45 @@ void View::defaults() {
     size = DEFAULT_SIZE;
     span = Point(DEFAULT_PAN,DEFAULT_PAN);
     is_scale_changed = false;
+    density = false;
+}
+
+// Leaving density mode shrinks a map larger than the label mode allows.
+void View::set_density(const bool on) {
+    density = on;
+    if (!density && size > MAX_SIZE)
+        size = MAX_SIZE;
 }
 
 // Show the game map.
-void View::show() const {
-    std::cout << "Display size: "  << size << ", scale: " << scale << ", origin: (" << span.x << ", " << span.y << ")" << std::endl;
+void View::show(const Model& model) const {
+    show(model.get_output(), model.get_sim_list());
+}
 
-    vector<std::vector<std::string>> grid(size, std::vector<std::string>(size, ". "));  // Vector of the map
-    const auto& sim_objs = Model::get_instance().get_sim_list();
+// Show the map of any objects, a sharded world draws the marks its regions sent.
+void View::show(std::ostream& out, const std::list<std::shared_ptr<Sim_Obj>>& objects) const {
+    out << "Display size: "  << size << ", scale: " << scale << ", origin: (" << span.x << ", " << span.y << ")" << std::endl;
+    if (density)
+        show_density(out, objects);
+    else
+        show_labels(out, objects);
+}
 
+bool View::cell_of(const Point& loc, int& ix, int& iy) const {
     const double offset_y = span.y , offset_x = span.x;
-    for (const auto& obj : sim_objs) {
-        const Point loc = obj->get_location();
-        const int ix = is_scale_changed ? static_cast<int>(std::ceil((loc.x - offset_x) / scale)) : static_cast<int>((loc.x - offset_x) / scale);
-        const int iy = is_scale_changed ? static_cast<int>(std::ceil((loc.y - offset_y) / scale)) : static_cast<int>((loc.y - offset_y) / scale);
+    ix = is_scale_changed ? static_cast<int>(std::ceil((loc.x - offset_x) / scale)) : static_cast<int>((loc.x - offset_x) / scale);
+    iy = is_scale_changed ? static_cast<int>(std::ceil((loc.y - offset_y) / scale)) : static_cast<int>((loc.y - offset_y) / scale);
+    return ix >= 0 && ix < size && iy >= 0 && iy < size;
+}
 
+void View::show_labels(std::ostream& out, const std::list<std::shared_ptr<Sim_Obj>>& objects) const {
+    vector<std::vector<std::string>> grid(size, std::vector<std::string>(size, ". "));  // Vector of the map
+
+    for (const auto& obj : objects) {
+        int ix, iy;
         // if im within map range, add a label to the map otherwise an object shouldn't be visible.
-        if (ix >= 0 && ix < size && iy >= 0 && iy < size) {
-            std::string name = obj->get_name();
+        if (cell_of(obj->get_location(), ix, iy)) {
+            const std::string& name = obj->get_name();
             const std::string label = name.substr(0, std::min<size_t>(2, name.size()));
             grid[iy][ix] = label;
         }
@@ -67,30 +88,91 @@ void View::show() const {
 
     // Print grid top to bottom
     for (int row = size - 1; row >= 0; --row) {
-        // Label every 3rd row with Y value
-        if (row % 3 == 0) {
-            const double y_val = span.y + row * scale;
-            std::cout << std::setw(4) << static_cast<int>(y_val) << " ";
-        } else {
-            std::cout << "     ";
-        }
+        print_row_label(out, row);
 
         // Print the row
         for (int col = 0; col < size; ++col) {
-            std::cout << grid[row][col];
+            out << grid[row][col];
+        }
+        out << std::endl;
+    }
+    print_x_axis(out);
+}
+
+// A cell is the letter of its most common type (Truck, Chopper, State trooper, Warehouse) and its count:
+// 1-9 as a digit, then a letter per power of ten (a: 10+, b: 100+, c: 1000+ ...).
+void View::show_density(std::ostream& out, const std::list<std::shared_ptr<Sim_Obj>>& objects) const {
+    enum { Trucks, Choppers, Troopers, Warehouses, Kinds };
+    static const char KIND_LETTERS[Kinds] = {'T', 'C', 'S', 'W'};
+
+    const std::size_t cells = static_cast<std::size_t>(size) * size;
+    std::vector<unsigned> counts(cells * Kinds, 0);     // Per cell, per type.
+    std::size_t totals[Kinds] = {};
+    for (const auto& obj : objects) {
+        int ix, iy;
+        if (!cell_of(obj->get_location(), ix, iy)) continue;
+        int kind = Warehouses;
+        switch (obj->get_kind()) {
+            case Sim_Obj::Truck_Kind: kind = Trucks; break;
+            case Sim_Obj::Chopper_Kind: kind = Choppers; break;
+            case Sim_Obj::Trooper_Kind: kind = Troopers; break;
+            case Sim_Obj::Warehouse_Kind: break;
+        }
+        ++counts[(static_cast<std::size_t>(iy) * size + ix) * Kinds + kind];
+        ++totals[kind];
+    }
+
+    std::string line(2 * static_cast<std::size_t>(size), ' ');     // One row, reused.
+    for (int row = size - 1; row >= 0; --row) {
+        print_row_label(out, row);
+        for (int col = 0; col < size; ++col) {
+            const unsigned* cell = &counts[(static_cast<std::size_t>(row) * size + col) * Kinds];
+            unsigned total = 0;
+            int top = 0;
+            for (int kind = 0; kind < Kinds; ++kind) {
+                total += cell[kind];
+                if (cell[kind] > cell[top]) top = kind;
+            }
+            char glyph = '.', amount = ' ';
+            if (total > 0) {
+                glyph = KIND_LETTERS[top];
+                if (total < 10)
+                    amount = static_cast<char>('0' + total);
+                else {
+                    amount = 'a';
+                    for (unsigned rest = total / 100; rest > 0; rest /= 10) ++amount;
+                }
+            }
+            line[2 * col] = glyph;
+            line[2 * col + 1] = amount;
         }
-        std::cout << std::endl;
+        out << line << '\n';
+    }
+    print_x_axis(out);
+    out << "Trucks: " << totals[Trucks] << ", Choppers: " << totals[Choppers]
+        << ", State troopers: " << totals[Troopers] << ", Warehouses: " << totals[Warehouses] << std::endl;
+}
+
+// Label every 3rd row with Y value
+void View::print_row_label(std::ostream& out, const int row) const {
+    if (row % 3 == 0) {
+        const double y_val = span.y + row * scale;
+        out << std::setw(4) << static_cast<int>(y_val) << " ";
+    } else {
+        out << "     ";
     }
+}
 
-    // print x-axis at the bottom
-    std::cout << "   ";
+// print x-axis at the bottom
+void View::print_x_axis(std::ostream& out) const {
+    out << "   ";
     for (int col = 0; col < size; ++col) {
         if (col % 3 == 0) {
             const double x_val = span.x + col * scale;
-            std::cout << std::setw(2) << static_cast<int>(x_val);
+            out << std::setw(2) << static_cast<int>(x_val);
         } else {
-            std::cout << "  ";
+            out << "  ";
         }
     }
-    std::cout << std::endl;
-}
\ No newline at end of file
+    out << std::endl;
+}
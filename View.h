@@ -1,7 +1,14 @@
 #ifndef VIEW_H
 #define VIEW_H
+#include <list>
+#include <memory>
+#include <ostream>
 #include "Geometry.h"
+
+class Model;
+class Sim_Obj;
 #define MAX_SIZE 30
+#define MAX_DENSITY_SIZE 400                // Largest map in density mode.
 #define MIN_SIZE 6
 #define MAX_SCALE 100
 #define MIN_SCALE 1
@@ -11,6 +18,8 @@
 
 /**
  * View class, Displays the game map with given parameters.
+ * In density mode every cell shows the most common object type and how many objects it holds,
+ * binned in one pass over the objects, so large worlds and maps up to MAX_DENSITY_SIZE stay readable.
  */
 class View {
 public:
@@ -21,13 +30,22 @@ public:
     void zoom(double _scale);   // Set map zoom.
     void pan(const Point& _pan);// set pan.
     void defaults();            // Set default parameters.
-    void show() const;          // Show the map.
+    void set_density(bool on);  // Switch between name labels and density counts.
+    void show(const Model& model) const;   // Show the map of the given world.
+    void show(std::ostream& out, const std::list<std::shared_ptr<Sim_Obj>>& objects) const;  // Show the map of objects.
 
 private:
+    bool cell_of(const Point& loc, int& ix, int& iy) const;  // Map cell of a location, false if off the map.
+    void show_labels(std::ostream& out, const std::list<std::shared_ptr<Sim_Obj>>& objects) const;   // Grid of two letter name labels.
+    void show_density(std::ostream& out, const std::list<std::shared_ptr<Sim_Obj>>& objects) const;  // Grid of per cell type and count.
+    void print_row_label(std::ostream& out, int row) const; // Y value every 3rd row.
+    void print_x_axis(std::ostream& out) const;             // X values under the map.
+
     double scale = DEFAULT_SCALE;                      // Map scale.
     int size = DEFAULT_SIZE;                          // Map size.
     Point span = Point(DEFAULT_PAN,DEFAULT_PAN); // Map pan.
     bool is_scale_changed = false;
+    bool density = false;                        // Density mode.
 };
 
 #endif //VIEW_H
\ No newline at end of file
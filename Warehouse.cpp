@@ -3,7 +3,7 @@
 
 // Warehouse constructor.
 Warehouse::Warehouse(const std::string &_name, const int _inventory, const float _x, const float _y) :
-                    Sim_Obj(_name),inventory(_inventory), location(_x,_y) {}
+                    Sim_Obj(_name, KIND),inventory(_inventory), location(_x,_y) {}
 
 // Returns the warehouse location on the map.
 Point Warehouse::get_location() const {
@@ -11,10 +11,9 @@ Point Warehouse::get_location() const {
 }
 
 // Broadcast warehouse state.
-void Warehouse::broadcast_current_state() const {
-    std::cout << "Warehouse " << get_name() << " at position ";
-    get_location().print();
-    std::cout << ", Inventory: " << inventory << std::endl;
+void Warehouse::broadcast_current_state(Status_Text& out) const {
+    out << "Warehouse " << get_name() << " at position " << get_location();
+    out << ", Inventory: " << inventory << '\n';
 }
 
 // Function that receives crate amount and bool add
@@ -23,10 +22,29 @@ void Warehouse::update_inventory(const int _update_val, const bool add) {
     inventory = add ? inventory + _update_val : inventory - _update_val;
 }
 
+int Warehouse::get_inventory() const {
+    return inventory;
+}
+
 // Make the warehouse as a main.
 void Warehouse::mark_main_warehouse() {
     main_warehouse = true;
 }
 
+// Set the warehouse index, given by Model when the warehouse is added.
+void Warehouse::set_index(const std::size_t _index) {
+    index = _index;
+}
+
+// Returns the warehouse index, used for route lookups.
+std::size_t Warehouse::get_index() const {
+    return index;
+}
+
 // Does nothing.
-void Warehouse::update() {}
\ No newline at end of file
+void Warehouse::update(double /*hours*/) {}
+
+void Warehouse::hash_state(State_Hash& hash) const {
+    hash.add(get_name());
+    hash.add(inventory);
+}
@@ -1,6 +1,7 @@
 #ifndef WAREHOUSE_H
 #define WAREHOUSE_H
 
+#include <cstddef>
 #include "Sim_Obj.h"
 /**
  * Warehouse class, extends Sim_Obj
@@ -8,18 +9,24 @@
  */
 class Warehouse final : public Sim_Obj{
 public:
+    static constexpr Kind KIND = Warehouse_Kind;
     explicit Warehouse(const std::string& _name,int _inventory, float _x, float _y);    // Explicit ctor
 
     Point get_location() const override;               // Location of warehouse getter.
-    void broadcast_current_state() const override;     // Broadcast warehouse state.
+    void broadcast_current_state(Status_Text& out) const override;     // Broadcast warehouse state.
     void update_inventory(int _update_val, bool add);  // Update warehouse inventory.
+    int get_inventory() const;                         // Current inventory.
     void mark_main_warehouse();                        // Is this warehouse the first one?.
-    void update() override;                            // Update warehouse state.
+    void set_index(std::size_t _index);                // Set index inside the Model warehouse table.
+    std::size_t get_index() const;                     // Index inside the Model warehouse table.
+    void update(double hours) override;                // Update warehouse state.
+    void hash_state(State_Hash& hash) const override;  // Mix the inventory into a checksum.
 
 private:
     int inventory;                  // Warehouse inventory.
     bool main_warehouse = false;    // Is this warehouse the main one.
     Point location;                 // Warehouse location
+    std::size_t index = 0;          // Index inside the Model warehouse table (routes).
 };
 
 #endif //WAREHOUSE_H
\ No newline at end of file
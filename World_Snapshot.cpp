@@ -0,0 +1,69 @@
+#include "World_Snapshot.h"
+#include <iomanip>
+#include "Chopper.h"
+#include "Sim_Types.h"
+#include "StateTrooper.h"
+#include "Truck.h"
+#include "Warehouse.h"
+
+static const char* const KIND_NAMES[] = {"Warehouse", "Truck", ROBBER, POLICE};
+static const char* const STATUS_NAMES[] = {"Stopped", "Parked", "Off road", "Heading on course", "Heading to"};
+
+void World_Snapshot::capture(const int _time, const int _minute_of_day, const std::size_t _registry_version,
+                             const std::list<std::shared_ptr<Sim_Obj>>& objects, const World_Snapshot* previous) {
+    time = _time;
+    minute_of_day = _minute_of_day;
+    registry_version = _registry_version;
+    if (previous && previous->registry_version == registry_version && previous->names) {
+        names = previous->names;
+    } else {
+        auto table = std::make_shared<std::vector<std::string>>();
+        table->reserve(objects.size());
+        for (const auto& obj : objects)
+            table->push_back(obj->get_name());
+        names = std::move(table);
+    }
+
+    entries.clear();
+    entries.reserve(objects.size());
+    for (const auto& obj : objects) {
+        const Point location = obj->get_location();
+        Entry entry{obj->get_kind(), location.x, location.y, 0.0, 0.0, 0, 0};
+        if (const auto* vehicle = sim_cast<Vehicle>(obj.get())) {
+            entry.course = vehicle->get_course();
+            entry.speed = vehicle->get_speed();
+            entry.status = vehicle->get_status();
+        }
+        switch (obj->get_kind()) {
+            case Sim_Obj::Warehouse_Kind: entry.value = static_cast<const Warehouse*>(obj.get())->get_inventory(); break;
+            case Sim_Obj::Truck_Kind: entry.value = static_cast<const Truck*>(obj.get())->get_reported_crates(); break;
+            case Sim_Obj::Chopper_Kind: entry.value = static_cast<const Chopper*>(obj.get())->get_stolen_crates(); break;
+            case Sim_Obj::Trooper_Kind: break;
+        }
+        entries.push_back(entry);
+    }
+}
+
+void World_Snapshot::print(std::ostream& out, const std::size_t index) const {
+    const Entry& entry = entries[index];
+    out << KIND_NAMES[entry.kind] << " " << (*names)[index] << " at (" << std::fixed << std::setprecision(2)
+        << entry.x << ", " << entry.y << ")";
+    if (entry.kind == Sim_Obj::Warehouse_Kind) {
+        out << ", Inventory: " << entry.value << "\n";
+        return;
+    }
+    out << ", " << STATUS_NAMES[entry.status] << ", course " << entry.course << " deg, speed " << entry.speed
+        << " km/h";
+    if (entry.kind == Sim_Obj::Truck_Kind)
+        out << ", Crates: " << entry.value;
+    else if (entry.kind == Sim_Obj::Chopper_Kind)
+        out << ", Stolen: " << entry.value;
+    out << "\n";
+}
+
+std::size_t World_Snapshot::find(const std::string_view name) const {
+    for (std::size_t i = 0; i < entries.size(); ++i)
+        if ((*names)[i] == name)
+            return i;
+    return entries.size();
+}
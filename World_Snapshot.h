@@ -0,0 +1,42 @@
+#ifndef WORLD_SNAPSHOT_H
+#define WORLD_SNAPSHOT_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Sim_Obj.h"
+
+/**
+ * World_Snapshot struct
+ * Immutable copy of the state of every object after a tick, read by other threads (query server).
+ * Names only change with the registry, so consecutive snapshots share one name table.
+ */
+struct World_Snapshot {
+    struct Entry {
+        Sim_Obj::Kind kind;
+        double x;
+        double y;
+        double course;                  // Vehicles only.
+        double speed;                   // Vehicles only.
+        int status;                     // Vehicle status, 0 for warehouses.
+        int value;                      // Inventory, crates on board or crates stolen.
+    };
+
+    int time = 0;                                               // Simulation time (hours).
+    int minute_of_day = 0;                                      // Simulation clock, minutes since 00:00.
+    std::size_t registry_version = 0;                           // Registry the names belong to.
+    std::shared_ptr<const std::vector<std::string>> names;      // Names in registry order.
+    std::vector<Entry> entries;                                 // State in registry order.
+
+    // Fill from the objects, the names of previous are reused while the registry is unchanged.
+    void capture(int _time, int _minute_of_day, std::size_t _registry_version,
+                 const std::list<std::shared_ptr<Sim_Obj>>& objects, const World_Snapshot* previous);
+    void print(std::ostream& out, std::size_t index) const;    // One object as a status line.
+    std::size_t find(std::string_view name) const;             // Index of an object, entries.size() if none.
+};
+
+#endif //WORLD_SNAPSHOT_H
@@ -0,0 +1,88 @@
+// Follows a shared memory position feed (feed <name>) and prints every new frame.
+// Build: g++ -std=c++17 -o feed_reader tools/feed_reader.cpp
+// Usage: feed_reader <name> [<frames>]
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../Position_Feed.h"
+
+static const char* const KIND_NAMES[] = {"Warehouse", "Truck", "Chopper", "State_trooper"};
+static const char* const STATUS_NAMES[] = {"Stopped", "Parked", "OffRoad", "MovingOnCourse", "MovingTo"};
+
+int main(const int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <name> [<frames>]" << std::endl;
+        return 1;
+    }
+    const std::string name = argv[1][0] == '/' ? argv[1] : "/" + std::string(argv[1]);
+    const long frames = argc == 3 ? std::atol(argv[2]) : -1;
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open shared memory <" << name << ">" << std::endl;
+        return 1;
+    }
+
+    const Feed_Header* header = nullptr;
+    std::size_t mapped = 0;
+    std::uint32_t last = 0;
+    std::int32_t time = 0;
+    std::int64_t seconds = 0;
+    std::vector<Feed_Record> records;
+    for (long shown = 0; frames < 0 || shown < frames;) {
+        // Mapped once, and again only when the writer grew the segment past the mapped size.
+        if (!header || feed_size(header->capacity) > mapped) {
+            struct stat info{};
+            if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Feed_Header))) {
+                std::cerr << "Error: Feed <" << name << "> is gone" << std::endl;
+                return 1;
+            }
+            if (header) ::munmap(const_cast<Feed_Header*>(header), mapped);
+            mapped = static_cast<std::size_t>(info.st_size);
+            header = static_cast<const Feed_Header*>(::mmap(nullptr, mapped, PROT_READ, MAP_SHARED, fd, 0));
+            if (header == MAP_FAILED || std::memcmp(header->magic, FEED_MAGIC, sizeof header->magic) != 0 ||
+                header->version != FEED_VERSION) {
+                std::cerr << "Error: <" << name << "> is not a position feed" << std::endl;
+                return 1;
+            }
+        }
+        // Seqlock read in place, without syscalls: retry while a frame is written or was written during the read.
+        const std::uint32_t before = header->sequence.load(std::memory_order_acquire);
+        if (before % 2 == 1 || before == last) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        const std::uint32_t count = header->count;
+        if (feed_size(count) > mapped) continue;    // Grown after mapping, map again.
+        time = header->time;
+        seconds = header->seconds;
+        const auto* shared = reinterpret_cast<const Feed_Record*>(header + 1);
+        records.assign(shared, shared + count);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->sequence.load(std::memory_order_relaxed) != before) continue;
+        last = before;
+
+        std::cout << "Frame " << before / 2 << ", time " << time << ", clock "
+                  << std::setw(2) << std::setfill('0') << seconds / 3600 % 24 << ":"
+                  << std::setw(2) << seconds / 60 % 60 << std::setfill(' ') << ", " << count << " objects\n";
+        for (const auto& record : records) {
+            std::cout << "  " << KIND_NAMES[record.kind % 4] << " " << record.name << " (" << std::fixed
+                      << std::setprecision(2) << record.x << ", " << record.y << ")";
+            if (record.kind != Sim_Obj::Warehouse_Kind)
+                std::cout << " " << STATUS_NAMES[record.status % 5] << " course " << record.course
+                          << " speed " << record.speed;
+            std::cout << "\n";
+        }
+        std::cout.flush();
+        ++shown;
+    }
+    return 0;
+}
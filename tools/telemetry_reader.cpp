@@ -0,0 +1,86 @@
+// Prints a telemetry recording (record <file>) as CSV, one row per vehicle and step.
+// Build: g++ -std=c++17 -o telemetry_reader tools/telemetry_reader.cpp
+// Usage: telemetry_reader <file> [<vehicle name>]
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../Telemetry_Writer.h"
+
+static const char* const STATUS_NAMES[] = {"Stopped", "Parked", "OffRoad", "MovingOnCourse", "MovingTo"};
+
+struct Entry {
+    char kind;
+    std::string name;
+};
+
+int main(const int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <file> [<vehicle name>]" << std::endl;
+        return 1;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file <" << argv[1] << ">" << std::endl;
+        return 1;
+    }
+    const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const std::size_t magic = std::strlen(TELEMETRY_MAGIC);
+    if (data.size() < magic + 1 || std::memcmp(data.data(), TELEMETRY_MAGIC, magic) != 0 ||
+        data[magic] != TELEMETRY_VERSION) {
+        std::cerr << "Error: Not a telemetry file" << std::endl;
+        return 1;
+    }
+    const std::string only = argc == 3 ? argv[2] : "";
+
+    std::vector<Entry> roster;
+    std::vector<std::int64_t> values[TELEMETRY_COLUMNS];
+    std::int64_t seconds = 0;
+    std::size_t pos = magic + 1;
+    std::uint64_t raw;
+    std::cout << "seconds,name,kind,x,y,course,speed,status,crates\n";
+    while (pos < data.size()) {
+        const std::uint8_t record = data[pos++];
+        if (record == TELEMETRY_ROSTER) {
+            if (!get_varint(data, pos, raw)) break;
+            roster.assign(raw, {});
+            for (auto& entry : roster) {
+                std::uint64_t length;
+                if (pos >= data.size()) break;
+                entry.kind = static_cast<char>(data[pos++]);
+                if (!get_varint(data, pos, length) || pos + length > data.size()) break;
+                entry.name.assign(data.begin() + static_cast<std::ptrdiff_t>(pos),
+                                  data.begin() + static_cast<std::ptrdiff_t>(pos + length));
+                pos += length;
+            }
+            for (auto& column : values)
+                column.assign(roster.size(), 0);
+        } else if (record == TELEMETRY_FRAME) {
+            if (!get_varint(data, pos, raw)) break;
+            seconds += zigzag_decode(raw);
+            for (auto& column : values)
+                for (auto& value : column) {
+                    if (!get_varint(data, pos, raw)) {
+                        std::cerr << "Error: Recording ends inside a frame" << std::endl;
+                        return 1;
+                    }
+                    value += zigzag_decode(raw);
+                }
+            for (std::size_t i = 0; i < roster.size(); ++i) {
+                if (!only.empty() && roster[i].name != only) continue;
+                const std::int64_t status = values[4][i];
+                std::cout << seconds << ',' << roster[i].name << ',' << roster[i].kind << ','
+                          << values[0][i] / TELEMETRY_SCALE << ',' << values[1][i] / TELEMETRY_SCALE << ','
+                          << values[2][i] / TELEMETRY_SCALE << ',' << values[3][i] / TELEMETRY_SCALE << ','
+                          << (status >= 0 && status < 5 ? STATUS_NAMES[status] : "?") << ','
+                          << values[5][i] << '\n';
+            }
+        } else {
+            std::cerr << "Error: Unknown record at byte " << pos - 1 << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Measures the cost of one vehicle step (begin, move, end) in Model::update.
+// The same fleet is also stepped by the baseline loop, dynamic_pointer_cast and virtual calls over the registry
+// as Model::update did before the closed type list, and both numbers are printed.
+// Build: g++ -std=c++17 -O2 -pthread -o update_bench tools/update_bench.cpp $(ls *.cpp | grep -v main.cpp)
+// Usage: update_bench [<vehicles>] [<hours>] [<stopped %>]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../Model.h"
+
+// Choppers fly on courses, troopers head for the warehouse, so both end_step paths run.
+// The given share of choppers stays stopped, the Model puts them to sleep.
+static void build_fleet(Model& model, const int count, const int stopped) {
+    model.set_sink(std::make_unique<Null_Sink>());     // Only the simulation is measured.
+    for (int i = 0; i < count; ++i) {
+        const std::string name = "V" + std::to_string(i);
+        const float x = static_cast<float>(i % 1000) / 10, y = static_cast<float>(i / 1000) / 10;
+        if (i % 4 == 3)
+            model.create_trooper(name, Point(x, y), "Frankfurt");
+        else
+            model.create_chopper(name, x, y);
+    }
+    int i = 0;
+    for (const auto& obj : model.get_sim_list()) {
+        if (auto* trooper = dynamic_cast<StateTrooper*>(obj.get()))
+            trooper->set_destination("Frankfurt");
+        else if (auto* chopper = dynamic_cast<Chopper*>(obj.get()); chopper && i % 100 >= stopped) {
+            chopper->set_parameters(50 + i % 100, i % 360);
+            chopper->set_status(Vehicle::MovingOnCourse);
+        }
+        ++i;
+    }
+    model.set_tick_minutes(1);
+}
+
+// One hour of sub-steps the way Model::update ran them before: every object is cast and stepped, asleep or not.
+static void baseline_update(Model& model) {
+    const int steps = 60 / model.get_tick_minutes();
+    const double hours = static_cast<double>(model.get_tick_minutes()) / 60;
+    for (int step = 0; step < steps; ++step) {
+        for (const auto& sim_obj : model.get_sim_list()) {
+            if (const auto vehicle = std::dynamic_pointer_cast<Vehicle>(sim_obj))
+                vehicle->begin_step();
+        }
+        model.get_kinematics().advance(hours);
+        for (const auto& sim_obj : model.get_sim_list()) {
+            if (const auto truck = std::dynamic_pointer_cast<Truck>(sim_obj)) {
+                if (truck->get_status() == Vehicle::Stopped || truck->get_status() == Vehicle::OffRoad)
+                    continue;
+                truck->end_step();
+            }
+        }
+        for (const auto& sim_obj : model.get_sim_list()) {
+            if (const auto chopper = std::dynamic_pointer_cast<Chopper>(sim_obj))
+                chopper->end_step();
+            else if (const auto trooper = std::dynamic_pointer_cast<StateTrooper>(sim_obj))
+                trooper->end_step();
+        }
+    }
+}
+
+// Runs hours of update on a fresh fleet and prints the time per vehicle step.
+template <typename Update>
+static void measure(const char* label, const int count, const int hours, const int stopped, Update update) {
+    Model model;
+    build_fleet(model, count, stopped);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int hour = 0; hour < hours; ++hour)
+        update(model);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double steps = static_cast<double>(count) * hours * (60 / model.get_tick_minutes());
+    std::cout << label << ": " << count << " vehicles, " << hours << " hours: " << elapsed.count() / 1e6 << " ms, "
+              << elapsed.count() / steps << " ns per vehicle step, " << model.get_active_count() << " active"
+              << std::endl;
+}
+
+int main(const int argc, char* argv[]) {
+    const int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int hours = argc > 2 ? std::atoi(argv[2]) : 5;
+    const int stopped = argc > 3 ? std::atoi(argv[3]) : 0;
+    if (count <= 0 || hours <= 0 || stopped < 0 || stopped > 100) {
+        std::cerr << "Usage: " << argv[0] << " [<vehicles>] [<hours>] [<stopped %>]" << std::endl;
+        return 1;
+    }
+
+    measure("baseline", count, hours, stopped, baseline_update);
+    measure("update  ", count, hours, stopped, [](Model& model) { model.update(); });
+    return 0;
+}